@@ -3,24 +3,85 @@
 namespace svm
 {
     Board::Board()
-        : memory(),
+        : trace(&cycles),
+          memory(),
           pic(),
           pit(pic),
-          cpu(memory, pic),
+          cpu(memory, pic, trace, &cycles),
+          disk(pic),
+          keyboard(pic, &cycles),
+          cache(),
+          cycles(0),
+          idle_cycles(0),
+          skipped_cycles(0),
+          idle([]() { return 0; }),
+          alarm_cycle(static_cast<cycles_type>(-1)),
+          alarm([]() { }),
           _working(false) { }
 
     Board::~Board() { }
 
     void Board::Start()
+    {
+        Run(NO_LIMIT);
+    }
+
+    bool Board::Run(cycles_type limit)
     {
         if (!_working) {
             _working = true;
 
-            while (_working) {
+            while (_working && cycles < limit) {
+                if (cycles >= alarm_cycle) {
+                    alarm();
+                    if (!_working) {
+                        break;
+                    }
+                }
+
+                if (cpu.halted) {
+                    // The cycle below still ticks, the alarm has to go off
+                    //   at its cycle
+                    cycles_type skipped = idle();
+                    if (alarm_cycle > cycles &&
+                            skipped > alarm_cycle - cycles - 1) {
+                        skipped = alarm_cycle - cycles - 1;
+                    }
+                    if (skipped > limit - cycles - 1) {
+                        skipped = limit - cycles - 1;
+                    }
+                    if (skipped > 0) {
+                        pit.FastForward(skipped);
+                        disk.FastForward(skipped);
+
+                        cycles += skipped;
+                        idle_cycles += skipped;
+                        skipped_cycles += skipped;
+                    }
+                }
+
                 pit.Tick();
-                cpu.Step();
+                disk.Tick();
+                keyboard.Tick();
+
+                if (cpu.halted) {
+                    ++idle_cycles;
+                } else if (cpu.stall_cycles > 0) {
+                    // The CPU is busy waiting for memory, the devices and
+                    //   the timer go on
+                    --cpu.stall_cycles;
+                } else {
+                    cpu.Step();
+                }
+
+                ++cycles;
             }
         }
+
+        bool stopped = !_working;
+        _working = false;
+
+        return stopped;
     }
 
     void Board::Stop()
@@ -0,0 +1,230 @@
+#include "cache.h"
+
+#include <cstdlib>
+#include <sstream>
+
+namespace svm
+{
+    CacheLevel::Config::Config()
+        : size(0),
+          associativity(1),
+          line_size(8),
+          policy(LeastRecentlyUsed) { }
+
+    bool CacheLevel::Config::Parse(const std::string &text, Config &config)
+    {
+        std::vector<std::string> fields;
+        std::stringstream stream(text);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 3 || fields.size() > 4) {
+            return false;
+        }
+
+        long values[3];
+        for (int i = 0; i < 3; ++i) {
+            char *end;
+            values[i] = std::strtol(fields[i].c_str(), &end, 10);
+            if (fields[i].empty() || *end != '\0' || values[i] <= 0) {
+                return false;
+            }
+        }
+
+        Policies policy = LeastRecentlyUsed;
+        if (fields.size() == 4) {
+            if (fields[3] == "fifo") {
+                policy = FirstInFirstOut;
+            } else if (fields[3] == "random") {
+                policy = Random;
+            } else if (fields[3] != "lru") {
+                return false;
+            }
+        }
+
+        // Whole sets of whole lines, no larger than RAM
+        Memory::ram_size_type size = static_cast<Memory::ram_size_type>(values[0]);
+        Memory::ram_size_type associativity =
+            static_cast<Memory::ram_size_type>(values[1]);
+        Memory::ram_size_type line_size =
+            static_cast<Memory::ram_size_type>(values[2]);
+        if (size > Memory::DEFAULT_RAM_SIZE ||
+                size % (associativity * line_size) != 0) {
+            return false;
+        }
+
+        config.size = size;
+        config.associativity = associativity;
+        config.line_size = line_size;
+        config.policy = policy;
+
+        return true;
+    }
+
+    CacheLevel::Way::Way()
+        : line(0),
+          valid(false),
+          stamp(0) { }
+
+    CacheLevel::CacheLevel()
+        : _config(),
+          _sets_count(0),
+          _lines_count(0),
+          _ways(),
+          _seen(),
+          _shadow(),
+          _shadow_lines(),
+          _clock(0),
+          _random_state(1) { }
+
+    void CacheLevel::Configure(const Config &config)
+    {
+        _config = config;
+        _lines_count = config.size / config.line_size;
+        _sets_count = _lines_count / config.associativity;
+
+        _ways.assign(_lines_count, Way());
+        _seen.assign(
+            (Memory::DEFAULT_RAM_SIZE + config.line_size - 1) / config.line_size,
+            false
+        );
+        _shadow.clear();
+        _shadow_lines.clear();
+        _clock = 0;
+        _random_state = 1;
+    }
+
+    bool CacheLevel::IsEnabled() const
+    {
+        return _lines_count > 0;
+    }
+
+    CacheLevel::Results CacheLevel::Access(Memory::ram_size_type address)
+    {
+        ++_clock;
+
+        Memory::ram_size_type line = address / _config.line_size;
+        bool shadow_hit = AccessShadow(line);
+
+        Way *set = &_ways[(line % _sets_count) * _config.associativity];
+        Way *victim = set;
+        for (Memory::ram_size_type i = 0; i < _config.associativity; ++i) {
+            Way &way = set[i];
+            if (way.valid && way.line == line) {
+                if (_config.policy == LeastRecentlyUsed) {
+                    way.stamp = _clock;
+                }
+
+                return Hit;
+            }
+
+            // An empty way first, then the oldest stamp
+            if (victim->valid &&
+                    (!way.valid || way.stamp < victim->stamp)) {
+                victim = &way;
+            }
+        }
+
+        if (victim->valid && _config.policy == Random) {
+            // xorshift32, the runs stay reproducible
+            _random_state ^= _random_state << 13;
+            _random_state ^= _random_state >> 17;
+            _random_state ^= _random_state << 5;
+            victim = &set[_random_state % _config.associativity];
+        }
+        victim->line = line;
+        victim->valid = true;
+        victim->stamp = _clock;
+
+        if (!_seen[line]) {
+            _seen[line] = true;
+            return CompulsoryMiss;
+        }
+
+        return shadow_hit ? ConflictMiss : CapacityMiss;
+    }
+
+    bool CacheLevel::AccessShadow(Memory::ram_size_type line)
+    {
+        auto shadow_line = _shadow_lines.find(line);
+        if (shadow_line != _shadow_lines.end()) {
+            _shadow.splice(_shadow.begin(), _shadow, shadow_line->second);
+            return true;
+        }
+
+        _shadow.push_front(line);
+        _shadow_lines[line] = _shadow.begin();
+        if (_shadow.size() > _lines_count) {
+            _shadow_lines.erase(_shadow.back());
+            _shadow.pop_back();
+        }
+
+        return false;
+    }
+
+    Cache::Config::Config()
+        : levels()
+    {
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            miss_penalties[level] = 0;
+        }
+    }
+
+    bool Cache::Config::IsEnabled() const
+    {
+        return levels[0].size > 0;
+    }
+
+    Cache::Counters::Counters()
+    {
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            for (int result = 0; result < CacheLevel::ResultsCount; ++result) {
+                results[level][result] = 0;
+            }
+        }
+    }
+
+    Cache::Cache()
+        : _config(),
+          _levels(),
+          _counters(),
+          _context_counters(&_counters[0]) { }
+
+    void Cache::Configure(const Config &config)
+    {
+        _config = config;
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            if (config.levels[level].size > 0) {
+                _levels[level].Configure(config.levels[level]);
+            }
+        }
+    }
+
+    unsigned int Cache::Access(Memory::ram_size_type address)
+    {
+        unsigned int stall_cycles = 0;
+        for (unsigned int level = 0;
+                 level < LEVELS && _levels[level].IsEnabled(); ++level) {
+            CacheLevel::Results result = _levels[level].Access(address);
+            ++_context_counters->results[level][result];
+            if (result == CacheLevel::Hit) {
+                break;
+            }
+            stall_cycles += _config.miss_penalties[level];
+        }
+
+        return stall_cycles;
+    }
+
+    void Cache::SetContext(context_type context)
+    {
+        // Map nodes do not move, the pointer stays valid
+        _context_counters = &_counters[context];
+    }
+
+    const Cache::counters_type &Cache::GetCounters() const
+    {
+        return _counters;
+    }
+}
@@ -0,0 +1,97 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace svm
+{
+    Checkpoint::Writer::Writer()
+        : buffer() { }
+
+    void Checkpoint::Writer::WriteBytes(const void *data, std::size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    Checkpoint::Reader::Reader()
+        : _data(NULL),
+          _size(0),
+          _position(0) { }
+
+    Checkpoint::Reader::~Reader()
+    {
+        if (_data) {
+            munmap(const_cast<char *>(_data), _size);
+        }
+    }
+
+    bool Checkpoint::Reader::Open(const std::string &path)
+    {
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            void *data =
+                mmap(
+                    NULL,
+                    static_cast<std::size_t>(status.st_size),
+                    PROT_READ,
+                    MAP_PRIVATE,
+                    descriptor,
+                    0
+                );
+            if (data != MAP_FAILED) {
+                _data = static_cast<const char *>(data);
+                _size = static_cast<std::size_t>(status.st_size);
+                _position = 0;
+            }
+        }
+
+        close(descriptor);
+
+        return _data != NULL;
+    }
+
+    bool Checkpoint::Reader::ReadBytes(void *data, std::size_t size)
+    {
+        if (_size - _position < size) {
+            return false;
+        }
+
+        std::memcpy(data, _data + _position, size);
+        _position += size;
+
+        return true;
+    }
+
+    bool Checkpoint::Save(const std::string &path, const buffer_type &buffer)
+    {
+        std::string temporary_path = path + ".tmp";
+
+        std::ofstream output_stream(
+            temporary_path,
+            std::ios::out | std::ios::binary | std::ios::trunc
+        );
+        if (!output_stream) {
+            return false;
+        }
+
+        output_stream.write(&buffer[0], buffer.size());
+        output_stream.close();
+        if (output_stream.fail()) {
+            return false;
+        }
+
+        return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+    }
+}
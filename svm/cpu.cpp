@@ -1,20 +1,47 @@
 #include "cpu.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 
 namespace svm
 {
     Registers::Registers()
         : a(0), b(0), c(0), flags(0), ip(0), sp(0) { }
 
-    CPU::CPU(Memory &memory, PIC &pic)
+    CPU::CPU(
+             Memory &memory,
+             PIC &pic,
+             Trace &trace,
+             const unsigned long long *cycles
+         )
         : registers(),
+          halted(false),
+          verified(false),
+          invalid_instructions(0),
+          instructions(0),
+          cache(NULL),
+          stall_cycles(0),
           _memory(memory),
-          _pic(pic) { }
+          _pic(pic),
+          _trace(trace),
+          _cycles(cycles) { }
 
     CPU::~CPU() { }
 
     void CPU::Step()
+    {
+        ++instructions;
+
+        if (cache) {
+            StepCached();
+        } else if (verified) {
+            StepVerified();
+        } else {
+            StepChecked();
+        }
+    }
+
+    void CPU::StepChecked()
     {
         int ip =
             registers.ip;
@@ -41,24 +68,19 @@ namespace svm
             registers.ip += data;
         } else if (instruction ==
                        CPU::INT_OPCODE) {
-            switch (data)
-            {
-                case 1:
-                    _pic.isr_3();
-                    break;
-                    //case 2:
-                    //  _pic.isr_5(); // `isr_4` is reserved for page fault
-                    //                // exceptions
-                    //  break;
-                    // ...
-            }
+            // Advance first, the handler may save the registers of the
+            //   caller and switch to another process
             registers.ip += 2;
+            _pic.syscall(data);
 	    } else if (instruction ==
                         CPU::LDA_OPCODE) { //load to register a
             auto virtual_page_index_and_offset = 
 				_memory.GetPageIndexAndOffsetForVirtualAddress(data);
             auto page_frame_index = 
-					_memory.page_table->at(virtual_page_index_and_offset.first);
+					_memory.GetPageEntry(
+                        _memory.page_table,
+                        virtual_page_index_and_offset.first
+                    );
             if (page_frame_index == Memory::INVALID_PAGE) {
                 auto previous_a = registers.a;
                 registers.a = virtual_page_index_and_offset.first;
@@ -68,15 +90,19 @@ namespace svm
                 auto physical_index = 
 						virtual_page_index_and_offset.second + 
 						Memory::PAGE_SIZE * page_frame_index;
+                _memory.referenced[page_frame_index] = 1;
                 registers.a = _memory.ram[physical_index];
-                ++instruction;
+                registers.ip += 2;
             }
         } else if (instruction ==
                         CPU::LDB_OPCODE) {
 			auto virtual_page_index_and_offset = 
 					_memory.GetPageIndexAndOffsetForVirtualAddress(data);
             auto page_frame_index = 
-					_memory.page_table->at(virtual_page_index_and_offset.first);
+					_memory.GetPageEntry(
+                        _memory.page_table,
+                        virtual_page_index_and_offset.first
+                    );
             if (page_frame_index == Memory::INVALID_PAGE) {
                 auto previous_a = registers.a;
                 registers.a = virtual_page_index_and_offset.first;
@@ -86,15 +112,19 @@ namespace svm
                 auto physical_index = 
 						virtual_page_index_and_offset.second + 
 						Memory::PAGE_SIZE * page_frame_index;
+                _memory.referenced[page_frame_index] = 1;
                 registers.b = _memory.ram[physical_index];
-                ++instruction;
+                registers.ip += 2;
             }
         } else if (instruction ==
                         CPU::LDC_OPCODE) {
 			auto virtual_page_index_and_offset = 
 				_memory.GetPageIndexAndOffsetForVirtualAddress(data);
             auto page_frame_index = 
-					_memory.page_table->at(virtual_page_index_and_offset.first);
+					_memory.GetPageEntry(
+                        _memory.page_table,
+                        virtual_page_index_and_offset.first
+                    );
             if (page_frame_index == Memory::INVALID_PAGE) {
                 auto previous_a = registers.a;
                 registers.a = virtual_page_index_and_offset.first;
@@ -104,15 +134,19 @@ namespace svm
                 auto physical_index = 
 						virtual_page_index_and_offset.second + 
 						Memory::PAGE_SIZE * page_frame_index;
+                _memory.referenced[page_frame_index] = 1;
                 registers.c = _memory.ram[physical_index];
-                ++instruction;
+                registers.ip += 2;
             }
         } else if (instruction ==
                         CPU::STA_OPCODE) {
 			auto virtual_page_index_and_offset = 
 				_memory.GetPageIndexAndOffsetForVirtualAddress(data);
             auto page_frame_index = 
-					_memory.page_table->at(virtual_page_index_and_offset.first);
+					_memory.GetPageEntry(
+                        _memory.page_table,
+                        virtual_page_index_and_offset.first
+                    );
             if (page_frame_index == Memory::INVALID_PAGE) {
                 auto previous_a = registers.a;
                 registers.a = virtual_page_index_and_offset.first;
@@ -122,15 +156,19 @@ namespace svm
                 auto physical_index = 
 						virtual_page_index_and_offset.second + 
 						Memory::PAGE_SIZE * page_frame_index;
+                _memory.referenced[page_frame_index] = 1;
                 _memory.ram[physical_index] = registers.a; // write to the physical memory
-                ++instruction;
+                registers.ip += 2;
             }
         } else if (instruction ==
                         CPU::STB_OPCODE) {
             auto virtual_page_index_and_offset = 
 				_memory.GetPageIndexAndOffsetForVirtualAddress(data);
             auto page_frame_index = 
-					_memory.page_table->at(virtual_page_index_and_offset.first);
+					_memory.GetPageEntry(
+                        _memory.page_table,
+                        virtual_page_index_and_offset.first
+                    );
             if (page_frame_index == Memory::INVALID_PAGE) {
                 auto previous_a = registers.a;
                 registers.a = virtual_page_index_and_offset.first;
@@ -140,15 +178,19 @@ namespace svm
                 auto physical_index = 
 						virtual_page_index_and_offset.second + 
 						Memory::PAGE_SIZE * page_frame_index;
+                _memory.referenced[page_frame_index] = 1;
                 _memory.ram[physical_index] = registers.b;
-                ++instruction;
+                registers.ip += 2;
             }
         } else if (instruction ==
                         CPU::STC_OPCODE) {
 			auto virtual_page_index_and_offset = 
 				_memory.GetPageIndexAndOffsetForVirtualAddress(data);
             auto page_frame_index = 
-					_memory.page_table->at(virtual_page_index_and_offset.first);
+					_memory.GetPageEntry(
+                        _memory.page_table,
+                        virtual_page_index_and_offset.first
+                    );
             if (page_frame_index == Memory::INVALID_PAGE) {
                 auto previous_a = registers.a;
                 registers.a = virtual_page_index_and_offset.first;
@@ -158,12 +200,258 @@ namespace svm
                 auto physical_index = 
 						virtual_page_index_and_offset.second + 
 						Memory::PAGE_SIZE * page_frame_index;
+                _memory.referenced[page_frame_index] = 1;
                 _memory.ram[physical_index] = registers.c;
-                ++instruction;
+                registers.ip += 2;
             }
+        } else if (instruction == CPU::CPY_OPCODE ||
+                       instruction == CPU::FILL_OPCODE ||
+                       instruction == CPU::CMP_OPCODE) {
+            StepBlock(instruction);
+        } else if (instruction >= CPU::RDCYCLEA_OPCODE &&
+                       instruction <= CPU::RDCYCLEC_OPCODE) {
+            int *rdcycle_registers[] = {
+                &registers.a, &registers.b, &registers.c
+            };
+            *rdcycle_registers[instruction - CPU::RDCYCLEA_OPCODE] =
+                static_cast<int>(*_cycles);
+            registers.ip += 2;
         } else {
-            std::cerr << "CPU: invalid opcode data. Skipping..."
-                      << std::endl;
+            ++invalid_instructions;
+            SVM_TRACE(
+                _trace, Trace::Errors,
+                Trace::InvalidOpcode, Trace::CURRENT_PROCESS,
+                instruction, registers.ip
+            );
+            registers.ip += 2;
+        }
+    }
+
+    void CPU::StepVerified()
+    {
+        const int *words = &_memory.ram[registers.ip];
+        int instruction = words[0];
+        int data = words[1];
+
+        // `ld`/`st` differ only in the register, `a`, `b`, `c` are in
+        //   this order in `Registers`
+        int *ld_st_registers[] = { &registers.a, &registers.b, &registers.c };
+
+        switch (instruction) {
+            case CPU::MOVA_OPCODE:
+                registers.a = data;
+                registers.ip += 2;
+                break;
+            case CPU::MOVB_OPCODE:
+                registers.b = data;
+                registers.ip += 2;
+                break;
+            case CPU::MOVC_OPCODE:
+                registers.c = data;
+                registers.ip += 2;
+                break;
+            case CPU::JMP_OPCODE:
+                registers.ip += data;
+                break;
+            case CPU::LDA_OPCODE:
+            case CPU::LDB_OPCODE:
+            case CPU::LDC_OPCODE:
+            case CPU::STA_OPCODE:
+            case CPU::STB_OPCODE:
+            case CPU::STC_OPCODE: {
+                Memory::vmem_size_type virtual_address =
+                    static_cast<Memory::vmem_size_type>(data);
+                Memory::page_table_size_type page =
+                    virtual_address / Memory::PAGE_SIZE;
+                Memory::page_entry_type page_frame_index =
+                    _memory.GetPageEntry(_memory.page_table, page);
+                if (page_frame_index == Memory::INVALID_PAGE) {
+                    auto previous_a = registers.a;
+                    registers.a = static_cast<int>(page);
+                    _pic.isr_4();
+                    registers.a = previous_a;
+                    break;
+                }
+
+                int &word =
+                    _memory.ram[
+                        virtual_address % Memory::PAGE_SIZE +
+                            Memory::PAGE_SIZE * page_frame_index
+                    ];
+                _memory.referenced[page_frame_index] = 1;
+                if (instruction < CPU::STA_OPCODE) {
+                    *ld_st_registers[instruction - CPU::LDA_OPCODE] = word;
+                } else {
+                    word = *ld_st_registers[instruction - CPU::STA_OPCODE];
+                }
+                registers.ip += 2;
+                break;
+            }
+            case CPU::RDCYCLEA_OPCODE:
+            case CPU::RDCYCLEB_OPCODE:
+            case CPU::RDCYCLEC_OPCODE:
+                *ld_st_registers[instruction - CPU::RDCYCLEA_OPCODE] =
+                    static_cast<int>(*_cycles);
+                registers.ip += 2;
+                break;
+            default:
+                // `int` and the block instructions take the usual path
+                StepChecked();
+                break;
+        }
+    }
+
+    void CPU::StepCached()
+    {
+        // One access per instruction at its first word. An access that
+        //   faults is not counted, the instruction runs again after the
+        //   fault
+        int instruction = _memory.ram[registers.ip];
+        bool is_ld_st =
+            (instruction >= CPU::LDA_OPCODE && instruction <= CPU::LDC_OPCODE) ||
+            (instruction >= CPU::STA_OPCODE && instruction <= CPU::STC_OPCODE);
+
+        Memory::ram_size_type data_address = 0;
+        bool is_mapped = true;
+        if (is_ld_st) {
+            auto virtual_page_index_and_offset =
+                _memory.GetPageIndexAndOffsetForVirtualAddress(
+                    _memory.ram[registers.ip + 1]
+                );
+            auto page_frame_index =
+                _memory.GetPageEntry(
+                    _memory.page_table,
+                    virtual_page_index_and_offset.first
+                );
+            is_mapped = page_frame_index != Memory::INVALID_PAGE;
+            data_address =
+                virtual_page_index_and_offset.second +
+                Memory::PAGE_SIZE * page_frame_index;
+        }
+
+        if (is_mapped) {
+            stall_cycles += cache->Access(registers.ip);
+            if (is_ld_st) {
+                stall_cycles += cache->Access(data_address);
+            }
+        }
+
+        if (verified) {
+            StepVerified();
+        } else {
+            StepChecked();
+        }
+    }
+
+    bool CPU::TranslateOrFault(
+                  unsigned int virtual_address,
+                  Memory::ram_size_type &physical_address
+              )
+    {
+        auto virtual_page_index_and_offset =
+            _memory.GetPageIndexAndOffsetForVirtualAddress(virtual_address);
+        auto page_frame_index =
+            _memory.GetPageEntry(
+                _memory.page_table,
+                virtual_page_index_and_offset.first
+            );
+        if (page_frame_index == Memory::INVALID_PAGE) {
+            auto previous_a = registers.a;
+            registers.a = virtual_page_index_and_offset.first;
+            _pic.isr_4();
+            registers.a = previous_a;
+
+            return false;
+        }
+
+        physical_address =
+            virtual_page_index_and_offset.second +
+            Memory::PAGE_SIZE * page_frame_index;
+        _memory.referenced[page_frame_index] = 1;
+
+        return true;
+    }
+
+    void CPU::StepBlock(int instruction)
+    {
+        if (registers.c <= 0) {
+            if (instruction == CPU::CMP_OPCODE) {
+                registers.flags = 0;
+            }
+            registers.ip += 2;
+
+            return;
+        }
+
+        unsigned int destination = static_cast<unsigned int>(registers.a);
+        unsigned int source = static_cast<unsigned int>(registers.b);
+
+        // The run ends at the first page boundary of either range, so
+        //   each side is translated once per page
+        Memory::ram_size_type run =
+            std::min<Memory::ram_size_type>(
+                registers.c,
+                Memory::PAGE_SIZE - destination % Memory::PAGE_SIZE
+            );
+        if (instruction != CPU::FILL_OPCODE) {
+            run =
+                std::min<Memory::ram_size_type>(
+                    run,
+                    Memory::PAGE_SIZE - source % Memory::PAGE_SIZE
+                );
+        }
+
+        Memory::ram_size_type destination_address;
+        Memory::ram_size_type source_address = 0;
+        if (!TranslateOrFault(destination, destination_address) ||
+                (instruction != CPU::FILL_OPCODE &&
+                     !TranslateOrFault(source, source_address))) {
+            return;
+        }
+
+        int *destination_words = &_memory.ram[destination_address];
+        int *source_words = &_memory.ram[source_address];
+
+        if (instruction == CPU::CPY_OPCODE) {
+            if (destination_words > source_words &&
+                    destination_words < source_words + run) {
+                // Same result as a forward loop of `ld`/`st`
+                for (Memory::ram_size_type i = 0; i < run; ++i) {
+                    destination_words[i] = source_words[i];
+                }
+            } else {
+                std::memmove(destination_words, source_words, run * sizeof(int));
+            }
+        } else if (instruction == CPU::FILL_OPCODE) {
+            std::fill(destination_words, destination_words + run, registers.b);
+        } else {
+            if (std::memcmp(destination_words, source_words, run * sizeof(int)) != 0) {
+                auto difference =
+                    std::mismatch(
+                        destination_words,
+                        destination_words + run,
+                        source_words
+                    );
+                int offset =
+                    static_cast<int>(difference.first - destination_words);
+
+                registers.a += offset;
+                registers.b += offset;
+                registers.c -= offset;
+                registers.flags = *difference.first < *difference.second ? -1 : 1;
+                registers.ip += 2;
+
+                return;
+            }
+            registers.flags = 0;
+        }
+
+        registers.a += static_cast<int>(run);
+        if (instruction != CPU::FILL_OPCODE) {
+            registers.b += static_cast<int>(run);
+        }
+        registers.c -= static_cast<int>(run);
+        if (registers.c == 0) {
             registers.ip += 2;
         }
     }
@@ -0,0 +1,259 @@
+#include "disk.h"
+
+#include <algorithm>
+
+namespace svm
+{
+    Disk::Request::Request()
+        : operation(Read),
+          block(0),
+          process_id(0),
+          virtual_address(0),
+          buffer(),
+          succeeded(false),
+          result_address(Memory::INVALID_PAGE),
+          submission_cycle(0),
+          completion_cycle(0) { }
+
+    Disk::Disk(PIC &pic)
+        : latency(DEFAULT_LATENCY),
+          exact_completions(false),
+          busy_cycles(0),
+          _file(),
+          _worker(),
+          _open(false),
+          _submitted(),
+          _stopping(false),
+          _finished(),
+          _finished_count(0),
+          _arrived(),
+          _completed(),
+          _in_flight(),
+          _passed_cycles_count(0),
+          _pic(pic) { }
+
+    Disk::~Disk()
+    {
+        if (_open) {
+            {
+                std::lock_guard<std::mutex> lock(_submitted_mutex);
+                _stopping = true;
+            }
+            _submitted_condition.notify_one();
+
+            _worker.join();
+        }
+    }
+
+    bool Disk::Open(const std::string &path)
+    {
+        if (_open) {
+            return false;
+        }
+
+        auto mode =
+            std::ios::in | std::ios::out | std::ios::binary;
+
+        _file.open(path, mode);
+        if (!_file) {
+            // The image does not exist yet, create an empty one
+            _file.clear();
+            _file.open(path, mode | std::ios::trunc);
+        }
+
+        if (_file) {
+            _open = true;
+            _worker = std::thread(&Disk::Work, this);
+        }
+
+        return _open;
+    }
+
+    bool Disk::IsOpen() const
+    {
+        return _open;
+    }
+
+    void Disk::Submit(Request &request)
+    {
+        request.buffer.resize(BLOCK_SIZE);
+        request.succeeded = false;
+        request.submission_cycle = _passed_cycles_count;
+        if (!exact_completions) {
+            request.completion_cycle = _passed_cycles_count + latency;
+        }
+
+        _in_flight.push_back(request.completion_cycle);
+
+        {
+            std::lock_guard<std::mutex> lock(_submitted_mutex);
+            _submitted.push_back(request);
+        }
+        _submitted_condition.notify_one();
+    }
+
+    bool Disk::TryGetCompletion(Request &request)
+    {
+        if (_completed.empty()) {
+            return false;
+        }
+
+        request = _completed.front();
+        _completed.pop_front();
+
+        return true;
+    }
+
+    bool Disk::HasOutstandingRequests() const
+    {
+        return !_in_flight.empty();
+    }
+
+    void Disk::Tick()
+    {
+        ++_passed_cycles_count;
+
+        if (_in_flight.empty()) {
+            return;
+        }
+
+        ++busy_cycles;
+
+        if (exact_completions && _arrived.empty() &&
+                _in_flight.front() <= _passed_cycles_count) {
+            // The completion is due but the host is late, stall the
+            //   board to keep the virtual timing
+            WaitForHost();
+        } else if (_finished_count.load(std::memory_order_acquire) > 0) {
+            CollectFinishedRequests();
+        }
+
+        bool completed = false;
+        while (!_arrived.empty() &&
+                   _arrived.front().completion_cycle <= _passed_cycles_count) {
+            _arrived.front().completion_cycle = _passed_cycles_count;
+            _completed.push_back(_arrived.front());
+            _arrived.pop_front();
+
+            _in_flight.pop_front();
+            completed = true;
+        }
+
+        if (completed) {
+            _pic.isr_2();
+        }
+    }
+
+    Disk::cycles_type Disk::CyclesUntilNextCompletion()
+    {
+        if (_in_flight.empty()) {
+            return 0;
+        }
+
+        if (_arrived.empty()) {
+            WaitForHost();
+        }
+
+        // `Tick` advances the counter before checking for completions
+        cycles_type completion_cycle = _arrived.front().completion_cycle;
+        if (completion_cycle <= _passed_cycles_count + 1) {
+            return 0;
+        }
+
+        return completion_cycle - _passed_cycles_count - 1;
+    }
+
+    void Disk::FastForward(cycles_type cycles)
+    {
+        _passed_cycles_count += cycles;
+
+        if (!_in_flight.empty()) {
+            busy_cycles += cycles;
+        }
+    }
+
+    Disk::cycles_type Disk::GetPassedCyclesCount() const
+    {
+        return _passed_cycles_count;
+    }
+
+    void Disk::SetPassedCyclesCount(cycles_type passed_cycles_count)
+    {
+        _passed_cycles_count = passed_cycles_count;
+    }
+
+    void Disk::WaitForHost()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_finished_mutex);
+            _finished_condition.wait(lock, [&]() {
+                return !_finished.empty();
+            });
+        }
+
+        CollectFinishedRequests();
+    }
+
+    void Disk::CollectFinishedRequests()
+    {
+        std::lock_guard<std::mutex> lock(_finished_mutex);
+        while (!_finished.empty()) {
+            _arrived.push_back(_finished.front());
+            _finished.pop_front();
+        }
+        _finished_count.store(0, std::memory_order_relaxed);
+    }
+
+    void Disk::Work()
+    {
+        for (;;) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(_submitted_mutex);
+                _submitted_condition.wait(lock, [&]() {
+                    return _stopping || !_submitted.empty();
+                });
+
+                if (_submitted.empty()) {
+                    break;
+                }
+
+                request = _submitted.front();
+                _submitted.pop_front();
+            }
+
+            auto block_bytes =
+                static_cast<std::streamsize>(BLOCK_SIZE * sizeof(int));
+            std::streamoff offset =
+                static_cast<std::streamoff>(request.block) * block_bytes;
+
+            _file.clear();
+            if (request.operation == Read) {
+                std::fill(request.buffer.begin(), request.buffer.end(), 0);
+
+                _file.seekg(offset);
+                _file.read(
+                    reinterpret_cast<char *>(&request.buffer[0]),
+                    block_bytes
+                );
+                // Blocks past the end of the image read as zeros
+                request.succeeded = !_file.bad();
+            } else {
+                _file.seekp(offset);
+                _file.write(
+                    reinterpret_cast<const char *>(&request.buffer[0]),
+                    block_bytes
+                );
+                _file.flush();
+                request.succeeded = !_file.fail();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_finished_mutex);
+                _finished.push_back(request);
+                _finished_count.fetch_add(1, std::memory_order_release);
+            }
+            _finished_condition.notify_one();
+        }
+    }
+}
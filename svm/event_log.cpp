@@ -0,0 +1,226 @@
+#include "event_log.h"
+
+#include <iterator>
+
+namespace svm
+{
+    EventLog::Event::Event()
+        : type(End),
+          cycle(0),
+          value(0),
+          words() { }
+
+    EventLog::EventLog()
+        : _output(),
+          _buffer(),
+          _last_cycle(0),
+          _recording(false),
+          _replaying(false) { }
+
+    EventLog::~EventLog()
+    {
+        Flush();
+    }
+
+    bool EventLog::OpenForRecording(const std::string &path)
+    {
+        _output.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!_output) {
+            return false;
+        }
+
+        unsigned int header[] = { MAGIC, VERSION };
+        _output.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+        _recording = true;
+        _last_cycle = 0;
+
+        return true;
+    }
+
+    bool EventLog::OpenForReplay(const std::string &path)
+    {
+        std::ifstream input_stream(path, std::ios::in | std::ios::binary);
+        if (!input_stream) {
+            return false;
+        }
+
+        unsigned int header[2];
+        if (!input_stream.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+                header[0] != MAGIC || header[1] != VERSION) {
+            return false;
+        }
+
+        std::vector<unsigned char> data(
+            (std::istreambuf_iterator<char>(input_stream)),
+            std::istreambuf_iterator<char>()
+        );
+
+        std::vector<unsigned char>::size_type position = 0;
+        cycles_type cycle = 0;
+        for (;;) {
+            unsigned long long type, cycle_delta, value, words_count;
+            if (!ReadNumber(data, position, type) || type >= EventsCount ||
+                    !ReadNumber(data, position, cycle_delta) ||
+                    !ReadNumber(data, position, value) ||
+                    !ReadNumber(data, position, words_count)) {
+                return false;
+            }
+
+            Event event;
+            event.type = static_cast<Events>(type);
+            cycle += static_cast<cycles_type>(
+                         (cycle_delta >> 1) ^ -(cycle_delta & 1)
+                     );
+            event.cycle = cycle;
+            event.value = static_cast<int>((value >> 1) ^ -(value & 1));
+
+            event.words.resize(words_count);
+            long long previous_word = 0;
+            for (auto &word : event.words) {
+                unsigned long long word_delta;
+                if (!ReadNumber(data, position, word_delta)) {
+                    return false;
+                }
+                previous_word +=
+                    static_cast<long long>((word_delta >> 1) ^ -(word_delta & 1));
+                word = static_cast<int>(previous_word);
+            }
+
+            _replayed[event.type].push_back(event);
+            if (event.type == End) {
+                break;
+            }
+        }
+
+        _replaying = true;
+
+        return true;
+    }
+
+    bool EventLog::IsRecording() const
+    {
+        return _recording;
+    }
+
+    bool EventLog::IsReplaying() const
+    {
+        return _replaying;
+    }
+
+    void EventLog::Record(const Event &event)
+    {
+        if (!_recording) {
+            return;
+        }
+
+        WriteNumber(event.type);
+        WriteSignedNumber(
+            static_cast<long long>(event.cycle) -
+                static_cast<long long>(_last_cycle)
+        );
+        WriteSignedNumber(event.value);
+        WriteNumber(event.words.size());
+
+        long long previous_word = 0;
+        for (auto word : event.words) {
+            WriteSignedNumber(word - previous_word);
+            previous_word = word;
+        }
+
+        _last_cycle = event.cycle;
+
+        if (_buffer.size() >= _FLUSH_THRESHOLD) {
+            Flush();
+        }
+    }
+
+    void EventLog::Close(cycles_type last_cycle)
+    {
+        if (!_recording) {
+            return;
+        }
+
+        Event event;
+        event.type = End;
+        event.cycle = last_cycle;
+        Record(event);
+
+        Flush();
+        _output.close();
+
+        _recording = false;
+    }
+
+    bool EventLog::Next(Events type, Event &event)
+    {
+        if (!Peek(type, event)) {
+            return false;
+        }
+
+        _replayed[type].pop_front();
+
+        return true;
+    }
+
+    bool EventLog::Peek(Events type, Event &event) const
+    {
+        if (_replayed[type].empty()) {
+            return false;
+        }
+
+        event = _replayed[type].front();
+
+        return true;
+    }
+
+    void EventLog::WriteNumber(unsigned long long number)
+    {
+        while (number >= 0x80) {
+            _buffer.push_back(static_cast<unsigned char>(number | 0x80));
+            number >>= 7;
+        }
+        _buffer.push_back(static_cast<unsigned char>(number));
+    }
+
+    void EventLog::WriteSignedNumber(long long number)
+    {
+        WriteNumber(
+            (static_cast<unsigned long long>(number) << 1) ^
+                static_cast<unsigned long long>(number >> 63)
+        );
+    }
+
+    void EventLog::Flush()
+    {
+        if (_output.is_open() && !_buffer.empty()) {
+            _output.write(
+                reinterpret_cast<const char *>(&_buffer[0]),
+                _buffer.size()
+            );
+        }
+        _buffer.clear();
+    }
+
+    bool EventLog::ReadNumber(
+                       const std::vector<unsigned char> &data,
+                       std::vector<unsigned char>::size_type &position,
+                       unsigned long long &number
+                   )
+    {
+        number = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (position >= data.size()) {
+                return false;
+            }
+
+            unsigned char byte = data[position++];
+            number |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
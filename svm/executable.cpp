@@ -0,0 +1,106 @@
+#include "executable.h"
+
+namespace svm
+{
+    Executable::Segment::Segment()
+        : type(Text),
+          offset(0),
+          file_size(0),
+          address(0),
+          memory_size(0) { }
+
+    Executable::Executable()
+        : entry(0),
+          priority(0),
+          expected_burst(0),
+          working_set(0),
+          segments() { }
+
+    bool Executable::Parse(const Memory::ram_type &image)
+    {
+        segments.clear();
+
+        if (image.empty() || image[0] != MAGIC) {
+            // Raw code, the burst is guessed from the size as before the
+            //   format existed
+            Segment text;
+            text.file_size = image.size();
+            text.memory_size = image.size();
+            segments.push_back(text);
+
+            entry = 0;
+            priority = 0;
+            expected_burst = image.size() / 2;
+            working_set = 0;
+
+            return true;
+        }
+
+        if (image.size() < _HEADER_SIZE || image[1] != VERSION ||
+                image[2] < 0 || image[3] < 0 || image[3] > 0xFFFF ||
+                image[4] < 0 || image[5] < 0 || image[6] < 1 ||
+                image[6] > SegmentsCount) {
+            return false;
+        }
+
+        entry = static_cast<Memory::ram_size_type>(image[2]);
+        priority = static_cast<Process::process_priority_type>(image[3]);
+        expected_burst = static_cast<Memory::ram_size_type>(image[4]);
+        working_set = static_cast<Memory::ram_size_type>(image[5]);
+
+        Memory::ram_size_type segments_count =
+            static_cast<Memory::ram_size_type>(image[6]);
+        if (image.size() < _HEADER_SIZE + segments_count * _SEGMENT_SIZE) {
+            return false;
+        }
+
+        bool seen[SegmentsCount] = { false, false, false };
+        for (Memory::ram_size_type i = 0; i < segments_count; ++i) {
+            const int *words = &image[_HEADER_SIZE + i * _SEGMENT_SIZE];
+            for (Memory::ram_size_type word = 0; word < _SEGMENT_SIZE; ++word) {
+                if (words[word] < 0) {
+                    return false;
+                }
+            }
+            if (words[0] >= SegmentsCount || seen[words[0]]) {
+                return false;
+            }
+            seen[words[0]] = true;
+
+            Segment segment;
+            segment.type = static_cast<Segments>(words[0]);
+            segment.offset = static_cast<Memory::ram_size_type>(words[1]);
+            segment.file_size = static_cast<Memory::ram_size_type>(words[2]);
+            segment.address = static_cast<Memory::vmem_size_type>(words[3]);
+            segment.memory_size = static_cast<Memory::ram_size_type>(words[4]);
+
+            // Only the words in the file are checked, bss has none
+            if (segment.offset % Memory::PAGE_SIZE != 0 ||
+                    (segment.file_size > 0 &&
+                         segment.offset + segment.file_size > image.size()) ||
+                    segment.file_size > segment.memory_size) {
+                return false;
+            }
+
+            segments.push_back(segment);
+        }
+
+        // An odd entry would run the text out of phase with the
+        //   instructions the verifier checked
+        const Segment *text = Find(Text);
+
+        return text != NULL && entry % 2 == 0 &&
+                   (entry < text->memory_size || entry == 0);
+    }
+
+    const Executable::Segment *Executable::Find(Segments type) const
+    {
+        for (auto &segment : segments) {
+            if (segment.type == type) {
+                return &segment;
+            }
+        }
+
+        return NULL;
+    }
+}
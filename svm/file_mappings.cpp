@@ -0,0 +1,217 @@
+#include "file_mappings.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace svm
+{
+    FileMappings::FileMappings()
+        : mappings(),
+          _files(),
+          _sizes() { }
+
+    bool FileMappings::Open(const std::vector<std::string> &paths)
+    {
+        if (paths.size() > MAX_FILES) {
+            return false;
+        }
+
+        for (auto &path : paths) {
+            _files.emplace_back(
+                path,
+                std::ios::in | std::ios::out | std::ios::binary
+            );
+            std::fstream &file = _files.back();
+            if (!file) {
+                return false;
+            }
+
+            file.seekg(0, std::ios::end);
+            _sizes.push_back(
+                static_cast<std::streamoff>(file.tellg()) /
+                    static_cast<std::streamoff>(sizeof(int))
+            );
+        }
+
+        return true;
+    }
+
+    unsigned int FileMappings::GetFilesCount() const
+    {
+        return static_cast<unsigned int>(_files.size());
+    }
+
+    FileMappings::page_type FileMappings::GetFilePagesCount(
+                                              unsigned int file
+                                          ) const
+    {
+        return static_cast<page_type>(
+                   (_sizes[file] + Memory::PAGE_SIZE - 1) / Memory::PAGE_SIZE
+               );
+    }
+
+    const FileMappings::Mapping *FileMappings::Find(
+                                                   Process::process_id_type process_id,
+                                                   page_type page
+                                               ) const
+    {
+        for (auto &mapping : mappings) {
+            if (mapping.process_id == process_id &&
+                    page >= mapping.first_page &&
+                    page < mapping.first_page + mapping.pages_count) {
+                return &mapping;
+            }
+        }
+
+        return NULL;
+    }
+
+    bool FileMappings::Overlaps(
+                           Process::process_id_type process_id,
+                           page_type first_page,
+                           page_type pages_count
+                       ) const
+    {
+        for (auto &mapping : mappings) {
+            if (mapping.process_id == process_id &&
+                    first_page < mapping.first_page + mapping.pages_count &&
+                    mapping.first_page < first_page + pages_count) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool FileMappings::ReadPage(
+                           const Mapping &mapping,
+                           page_type page,
+                           int *words
+                       )
+    {
+        std::fill(words, words + Memory::PAGE_SIZE, 0);
+
+        std::streamsize words_count;
+        if (!Seek(mapping, page, words_count)) {
+            return false;
+        }
+
+        std::fstream &file = _files[mapping.file];
+        file.read(
+            reinterpret_cast<char *>(words),
+            words_count * static_cast<std::streamsize>(sizeof(int))
+        );
+
+        return !file.fail();
+    }
+
+    bool FileMappings::WritePage(
+                           const Mapping &mapping,
+                           page_type page,
+                           const int *words
+                       )
+    {
+        // Pages that were only read cost a read instead of a write
+        int file_words[Memory::PAGE_SIZE];
+        if (!ReadPage(mapping, page, file_words)) {
+            return false;
+        }
+
+        std::streamsize words_count;
+        if (!Seek(mapping, page, words_count)) {
+            return false;
+        }
+        std::size_t bytes_count =
+            static_cast<std::size_t>(words_count) * sizeof(int);
+        if (std::memcmp(words, file_words, bytes_count) == 0) {
+            return true;
+        }
+
+        std::fstream &file = _files[mapping.file];
+        file.write(
+            reinterpret_cast<const char *>(words),
+            static_cast<std::streamsize>(bytes_count)
+        );
+        file.flush();
+
+        return !file.fail();
+    }
+
+    bool FileMappings::Seek(
+                           const Mapping &mapping,
+                           page_type page,
+                           std::streamsize &words_count
+                       )
+    {
+        std::streamoff offset =
+            static_cast<std::streamoff>(
+                mapping.file_page + page - mapping.first_page
+            ) * Memory::PAGE_SIZE;
+        words_count =
+            static_cast<std::streamsize>(
+                std::max<std::streamoff>(
+                    std::min<std::streamoff>(
+                        _sizes[mapping.file] - offset,
+                        Memory::PAGE_SIZE
+                    ),
+                    0
+                )
+            );
+
+        std::fstream &file = _files[mapping.file];
+        file.clear();
+        file.seekg(offset * static_cast<std::streamoff>(sizeof(int)));
+        file.seekp(offset * static_cast<std::streamoff>(sizeof(int)));
+
+        return !file.fail();
+    }
+
+    void FileMappings::Write(Checkpoint::Writer &writer) const
+    {
+        writer.Write(GetFilesCount());
+
+        writer.Write(static_cast<unsigned long long>(mappings.size()));
+        for (auto &mapping : mappings) {
+            writer.Write(mapping.process_id);
+            writer.Write(mapping.file);
+            writer.Write(static_cast<unsigned long long>(mapping.first_page));
+            writer.Write(static_cast<unsigned long long>(mapping.pages_count));
+            writer.Write(static_cast<unsigned long long>(mapping.file_page));
+        }
+    }
+
+    bool FileMappings::Read(
+                           Checkpoint::Reader &reader,
+                           std::vector<Mapping> &restored
+                       ) const
+    {
+        restored.clear();
+
+        // The files are given again on the command line of the restore
+        unsigned int files_count;
+        unsigned long long mappings_count;
+        if (!reader.Read(files_count) || files_count != GetFilesCount() ||
+                !reader.Read(mappings_count)) {
+            return false;
+        }
+        for (unsigned long long i = 0; i < mappings_count; ++i) {
+            Mapping mapping;
+            unsigned long long first_page, pages_count, file_page;
+            if (!reader.Read(mapping.process_id) ||
+                    !reader.Read(mapping.file) ||
+                    !reader.Read(first_page) ||
+                    !reader.Read(pages_count) ||
+                    !reader.Read(file_page) ||
+                    mapping.file >= GetFilesCount()) {
+                return false;
+            }
+            mapping.first_page = static_cast<page_type>(first_page);
+            mapping.pages_count = static_cast<page_type>(pages_count);
+            mapping.file_page = static_cast<page_type>(file_page);
+
+            restored.push_back(mapping);
+        }
+
+        return true;
+    }
+}
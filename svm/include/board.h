@@ -1,24 +1,55 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "cache.h"
 #include "memory.h"
 #include "pic.h"
 #include "pit.h"
 #include "cpu.h"
+#include "disk.h"
+#include "keyboard.h"
+#include "trace.h"
+
+#include <functional>
 
 namespace svm
 {
     // Virtual Machine
     //
-    // Combines all components (CPU, memory, timer, interrupt controller)
+    // Combines all components (CPU, memory, timer, interrupt controller,
+    // disk, keyboard)
     // Orchestrates their execution
     class Board
     {
         public:
+            typedef unsigned long long cycles_type;
+
+            static const cycles_type NO_LIMIT = static_cast<cycles_type>(-1);
+
+            Trace trace; // Stamped with `cycles`
+
             Memory memory;
             PIC pic;
             PIT pit;
             CPU cpu;
+            Disk disk;
+            Keyboard keyboard; // Host input on IRQ 1
+            Cache cache;       // Attached to the CPU by the kernel
+
+            cycles_type cycles;         // Virtual cycles passed since the start
+            cycles_type idle_cycles;    // Cycles the CPU spent halted
+            cycles_type skipped_cycles; // Idle cycles jumped over at once
+
+            // Called while the CPU is halted. Returns how many cycles pass
+            //   before the next pending event, the board jumps over them
+            //   without ticking the devices (0 to keep ticking)
+            std::function<cycles_type()> idle;
+
+            // Called at the start of cycle `alarm_cycle` (before the devices
+            //   tick), the handler re-arms it. Idle fast-forwarding stops
+            //   at the alarm
+            cycles_type alarm_cycle;
+            std::function<void()> alarm;
 
             Board();
             virtual ~Board();
@@ -26,6 +57,10 @@ namespace svm
             void Start(); // Starts the cpu, timer, etc.
             void Stop();  // Stops...
 
+            // Runs until `Stop` or until `cycles` reaches `limit`, the
+            //   next call continues. Returns true if it was stopped
+            bool Run(cycles_type limit);
+
         private:
             bool _working;
     };
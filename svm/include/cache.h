@@ -0,0 +1,148 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "memory.h"
+
+namespace svm
+{
+    // Cache Level
+    //
+    // Tags of one set associative cache in front of RAM, the words stay in
+    // RAM. Misses are compulsory (the first reference to the line),
+    // capacity (a fully associative LRU cache of the same size misses as
+    // well) or conflict ones
+    class CacheLevel
+    {
+        public:
+            enum Policies
+            {
+                LeastRecentlyUsed,
+                FirstInFirstOut,
+                Random
+            };
+
+            enum Results
+            {
+                Hit,
+                CompulsoryMiss,
+                CapacityMiss,
+                ConflictMiss,
+                ResultsCount
+            };
+
+            struct Config
+            {
+                Memory::ram_size_type size;      // Words, 0 for no cache
+                Memory::ram_size_type associativity;
+                Memory::ram_size_type line_size; // Words
+                Policies policy;
+
+                Config();
+
+                // `<size>,<ways>,<line size>[,lru|fifo|random]`, returns
+                //   false if the text or the geometry is invalid
+                static bool Parse(const std::string &text, Config &config);
+            };
+
+            CacheLevel();
+
+            void Configure(const Config &config);
+            bool IsEnabled() const;
+
+            Results Access(Memory::ram_size_type address);
+
+        private:
+            struct Way
+            {
+                Memory::ram_size_type line;
+                bool valid;
+                unsigned long long stamp; // Last use (LRU) or the fill (FIFO)
+
+                Way();
+            };
+
+            typedef std::list<Memory::ram_size_type> shadow_type;
+
+            Config _config;
+            Memory::ram_size_type _sets_count;
+            Memory::ram_size_type _lines_count;
+
+            std::vector<Way> _ways; // `associativity` ways per set
+            std::vector<bool> _seen; // Lines referenced at least once
+
+            // Fully associative LRU cache of the same size, most recent
+            //   line first
+            shadow_type _shadow;
+            std::unordered_map<
+                Memory::ram_size_type,
+                shadow_type::iterator
+            > _shadow_lines;
+
+            unsigned long long _clock;
+            unsigned int _random_state;
+
+            bool AccessShadow(Memory::ram_size_type line);
+    };
+
+    // Cache Hierarchy
+    //
+    // Optional model of L1 and L2 caches on the instruction fetch and the
+    // `ld`/`st` paths of the CPU. L2 is looked up on L1 misses only and
+    // both are filled (non-inclusive). Results are counted per process,
+    // the kernel names the running one. A miss may be charged as stall
+    // cycles, the board waits them out before the next instruction
+    class Cache
+    {
+        public:
+            static const unsigned int LEVELS = 2;
+
+            typedef unsigned int context_type; // Process ID
+
+            struct Config
+            {
+                CacheLevel::Config levels[LEVELS];
+                unsigned int miss_penalties[LEVELS]; // Cycles, 0 charges
+                                                     //   nothing
+
+                Config();
+
+                // L2 is used only behind L1
+                bool IsEnabled() const;
+            };
+
+            struct Counters
+            {
+                unsigned long long
+                    results[LEVELS][CacheLevel::ResultsCount];
+
+                Counters();
+            };
+
+            typedef std::map<context_type, Counters> counters_type;
+
+            Cache();
+
+            void Configure(const Config &config);
+
+            // Returns the stall cycles of the access
+            unsigned int Access(Memory::ram_size_type address);
+
+            void SetContext(context_type context);
+            const counters_type &GetCounters() const;
+
+        private:
+            Config _config;
+            CacheLevel _levels[LEVELS];
+
+            counters_type _counters;
+            Counters *_context_counters;
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace svm
+{
+    // Machine Checkpoint
+    //
+    // A versioned binary image of the machine state. Values are stored in
+    // the host byte order, the kernel decides what goes into the image
+    class Checkpoint
+    {
+        public:
+            typedef std::vector<char> buffer_type;
+
+            static const unsigned int MAGIC   = 0x434d5653; // "SVMC"
+            static const unsigned int VERSION = 13;
+
+            // Appends values to an in-memory image
+            class Writer
+            {
+                public:
+                    buffer_type buffer;
+
+                    Writer();
+
+                    template <typename T>
+                    void Write(T value)
+                    {
+                        WriteBytes(&value, sizeof(value));
+                    }
+
+                    void WriteBytes(const void *data, std::size_t size);
+            };
+
+            // Reads values from an image mapped into the host memory. Only
+            //   the parts that are read get paged in
+            class Reader
+            {
+                public:
+                    Reader();
+                    virtual ~Reader();
+
+                    bool Open(const std::string &path);
+
+                    template <typename T>
+                    bool Read(T &value)
+                    {
+                        return ReadBytes(&value, sizeof(value));
+                    }
+
+                    bool ReadBytes(void *data, std::size_t size);
+
+                private:
+                    Reader(const Reader &);
+                    Reader &operator=(const Reader &);
+
+                    const char *_data;
+                    std::size_t _size;
+                    std::size_t _position;
+            };
+
+            // Writes the image to `path` through a temporary file so that
+            //   an interrupted write never replaces a good checkpoint
+            static bool Save(const std::string &path, const buffer_type &buffer);
+    };
+}
+
+#endif
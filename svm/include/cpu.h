@@ -1,8 +1,10 @@
 #ifndef CPU_H
 #define CPU_H
 
+#include "cache.h"
 #include "memory.h"
 #include "pic.h"
+#include "trace.h"
 
 namespace svm
 {
@@ -47,17 +49,84 @@ namespace svm
                              STB_OPCODE = 0x51,
 							 STC_OPCODE = 0x52;
 
+            /*
+             *   cpy  # Copy `c` words from address `b` to address `a`
+             *   fill # Fill `c` words at address `a` with the value of `b`
+             *   cmp  # Compare `c` words at addresses `a` and `b`
+             *
+             *   One page run is done per step and the registers are
+             *   advanced past it, so a page fault or a preemption in the
+             *   middle restarts the instruction where it stopped. It
+             *   completes when `c` reaches 0. `cmp` stops early at the
+             *   first difference with `flags` set to -1 or 1 (0 if equal)
+             *   and `a`, `b`, `c` at the differing words
+             */
+            static const int CPY_OPCODE  = 0x60,
+                             FILL_OPCODE = 0x61,
+                             CMP_OPCODE  = 0x62;
+
+            /*
+             *   rdcycle a # Load the low 32 bits of the virtual cycle
+             *             #   counter into the register 'a'
+             *
+             *   The difference of two reads is exact for intervals
+             *   shorter than 2^32 cycles
+             */
+            static const int RDCYCLEA_OPCODE = 0x70,
+                             RDCYCLEB_OPCODE = 0x71,
+                             RDCYCLEC_OPCODE = 0x72;
+
             Registers registers; // Current state of the CPU
+            bool halted;         // Set by the kernel when nothing is
+                                 //   runnable, the board skips `Step`
+            bool verified;       // Set by the kernel when the running
+                                 //   process passed the `Verifier`
+
+            unsigned long long invalid_instructions; // Skipped so far
+            unsigned long long instructions; // Steps taken so far, a step
+                                             //   that faults counts too
 
-            CPU(Memory &memory, PIC &pic);
+            Cache *cache; // Set by the kernel when the cache model is on,
+                          //   NULL keeps it out of the instruction paths
+            unsigned int stall_cycles; // Charged by the cache model, the
+                                       //   board waits them out
+
+            CPU(
+                Memory &memory,
+                PIC &pic,
+                Trace &trace,
+                const unsigned long long *cycles // Read by `rdcycle`
+            );
             virtual ~CPU();
 
             void Step(); // Executes one instruction, advances the instruction
                          //  pointer
 
         private:
+            void StepChecked();
+
+            // Fast path for verified processes: the opcode, the jump
+            //   targets and the page indices are known to be valid
+            void StepVerified();
+
+            // Passes the fetch and the word of `ld`/`st` through the cache,
+            //   then executes the instruction on the usual path
+            void StepCached();
+
+            // Raises a page fault and returns false if the page is not
+            //   mapped
+            bool TranslateOrFault(
+                     unsigned int virtual_address,
+                     Memory::ram_size_type &physical_address
+                 );
+
+            // Executes the next page run of a block instruction
+            void StepBlock(int instruction);
+
             Memory &_memory;
             PIC &_pic;
+            Trace &_trace;
+            const unsigned long long *_cycles;
     };
 }
 
@@ -0,0 +1,128 @@
+#ifndef DISK_H
+#define DISK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "memory.h"
+#include "pic.h"
+
+namespace svm
+{
+    // Block Device
+    //
+    // A virtual disk backed by a local file. Requests are executed on a host
+    // I/O thread while the CPU keeps running. Finished requests are
+    // delivered on the board thread through IRQ 2 after the configured
+    // virtual latency has passed
+    class Disk
+    {
+        public:
+            typedef unsigned long long cycles_type;
+            typedef Memory::ram_size_type block_index_type;
+
+            static const Memory::ram_size_type BLOCK_SIZE = Memory::PAGE_SIZE;
+            // Writes may grow the image up to this many blocks
+            static const block_index_type MAX_BLOCKS = 65536;
+            static const cycles_type DEFAULT_LATENCY = 1000;
+
+            enum Operations
+            {
+                Read, Write
+            };
+
+            struct Request
+            {
+                Operations operation;
+                block_index_type block;
+
+                unsigned int process_id;
+                Memory::vmem_size_type virtual_address;
+
+                Memory::ram_type buffer; // BLOCK_SIZE words to write or read
+                bool succeeded;
+
+                Memory::ram_size_type result_address; // Physical address of
+                                                      //   the batch entry,
+                                                      //   INVALID_PAGE if none
+
+                cycles_type submission_cycle;
+                cycles_type completion_cycle;
+
+                Request();
+            };
+
+            cycles_type latency; // Virtual cycles a request takes at least
+
+            // Deliver every request exactly at the `completion_cycle` set by
+            //   the submitter (replay), waiting for the host if it is late
+            bool exact_completions;
+
+            cycles_type busy_cycles; // Cycles with at least one request
+                                     //   in flight
+
+            Disk(PIC &pic);
+            virtual ~Disk();
+
+            // Opens (or creates) the backing file and starts the I/O thread
+            bool Open(const std::string &path);
+            bool IsOpen() const;
+
+            // Queues a request for the I/O thread
+            void Submit(Request &request);
+            // Takes the next finished request delivered with IRQ 2
+            bool TryGetCompletion(Request &request);
+
+            bool HasOutstandingRequests() const;
+            // Cycles left before the next completion is raised. Waits for the
+            //   host if the oldest request is still executing there. Returns
+            //   0 when nothing is in flight
+            cycles_type CyclesUntilNextCompletion();
+
+            void Tick(); // Raises isr_2 when requests complete
+            void FastForward(cycles_type cycles);
+
+            // Counter state for checkpoints
+            cycles_type GetPassedCyclesCount() const;
+            void SetPassedCyclesCount(cycles_type passed_cycles_count);
+
+        private:
+            void Work(); // I/O thread body
+            void WaitForHost();
+            void CollectFinishedRequests();
+
+            std::fstream _file;
+            std::thread _worker;
+            bool _open;
+
+            // Board thread -> I/O thread
+            std::mutex _submitted_mutex;
+            std::condition_variable _submitted_condition;
+            std::deque<Request> _submitted;
+            bool _stopping;
+
+            // I/O thread -> board thread
+            std::mutex _finished_mutex;
+            std::condition_variable _finished_condition;
+            std::deque<Request> _finished;
+            std::atomic<unsigned int> _finished_count;
+
+            // Board thread only
+            std::deque<Request> _arrived;   // done on the host, waiting for
+                                            //   the virtual latency
+            std::deque<Request> _completed; // waiting for the kernel
+            std::deque<cycles_type> _in_flight; // completion cycles of the
+                                                //   requests not delivered
+            cycles_type _passed_cycles_count;
+
+            PIC &_pic;
+    };
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "memory.h"
+
+namespace svm
+{
+    // Record/Replay Event Log
+    //
+    // Nondeterministic inputs of a run stamped with the virtual cycle they
+    // were delivered at. Events are stored as variable-length integers:
+    // the cycle as a delta from the previous event and word payloads as
+    // zigzag deltas from the previous word, so typical images and buffers
+    // take one or two bytes per word
+    class EventLog
+    {
+        public:
+            typedef unsigned long long cycles_type;
+
+            static const unsigned int MAGIC   = 0x524d5653; // "SVMR"
+            static const unsigned int VERSION = 1;
+
+            enum Events
+            {
+                End,            // value: 0, cycle: the last cycle of the run
+                Admission,      // words: the executable image
+                DiskCompletion, // value: success, words: data read
+                HostInput,      // value: words read (0 at the end of the
+                                //   input), words: the input
+                EventsCount
+            };
+
+            struct Event
+            {
+                Events type;
+                cycles_type cycle;
+                int value;
+                Memory::ram_type words;
+
+                Event();
+            };
+
+            EventLog();
+            virtual ~EventLog();
+
+            bool OpenForRecording(const std::string &path);
+            bool OpenForReplay(const std::string &path);
+
+            bool IsRecording() const;
+            bool IsReplaying() const;
+
+            // Recording
+            void Record(const Event &event);
+            void Close(cycles_type last_cycle); // Writes `End` and flushes
+
+            // Replay: events of each type come back in the recorded order
+            bool Next(Events type, Event &event);
+            bool Peek(Events type, Event &event) const;
+
+        private:
+            static const std::vector<unsigned char>::size_type
+                _FLUSH_THRESHOLD = 0x10000;
+
+            void WriteNumber(unsigned long long number);
+            void WriteSignedNumber(long long number);
+            void Flush();
+
+            bool ReadNumber(
+                     const std::vector<unsigned char> &data,
+                     std::vector<unsigned char>::size_type &position,
+                     unsigned long long &number
+                 );
+
+            std::ofstream _output;
+            std::vector<unsigned char> _buffer;
+            cycles_type _last_cycle;
+
+            bool _recording;
+            bool _replaying;
+            std::deque<Event> _replayed[EventsCount];
+    };
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef EXECUTABLE_H
+#define EXECUTABLE_H
+
+#include <vector>
+
+#include "memory.h"
+#include "process.h"
+
+namespace svm
+{
+    // SVM Object Format
+    //
+    // A header with the entry point and the hints for the scheduler and the
+    // frame allocator, then the segments. Every segment starts at a page
+    // aligned offset of the image, so the loader copies it page by page
+    // without looking at the code. Images without the magic are raw code
+    // from older assemblers
+    class Executable
+    {
+        public:
+            static const int MAGIC   = 0x584d5653; // "SVMX"
+            static const int VERSION = 1;
+
+            enum Segments
+            {
+                Text, // Code, copied into the kernel heap
+                Data, // Initialized words at a virtual address
+                Bss,  // Zero-filled words at a virtual address
+                SegmentsCount
+            };
+
+            struct Segment
+            {
+                Segments type;
+                Memory::ram_size_type offset;      // In the image
+                Memory::ram_size_type file_size;
+                Memory::vmem_size_type address;    // Ignored for text
+                Memory::ram_size_type memory_size; // At least `file_size`,
+                                                   //   the rest is zeroed
+
+                Segment();
+            };
+
+            Memory::ram_size_type entry;          // Offset in text, on an
+                                                  //   instruction boundary
+            Process::process_priority_type priority;
+            Memory::ram_size_type expected_burst; // Instructions
+            Memory::ram_size_type working_set;    // Pages
+
+            std::vector<Segment> segments;
+
+            Executable();
+
+            // Returns false if the header is damaged
+            bool Parse(const Memory::ram_type &image);
+
+            // NULL if the image does not have the segment
+            const Segment *Find(Segments type) const;
+
+        private:
+            static const Memory::ram_size_type _HEADER_SIZE  = 7;
+            static const Memory::ram_size_type _SEGMENT_SIZE = 5;
+    };
+}
+
+#endif
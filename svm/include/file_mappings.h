@@ -0,0 +1,96 @@
+#ifndef FILE_MAPPINGS_H
+#define FILE_MAPPINGS_H
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "checkpoint.h"
+#include "memory.h"
+#include "process.h"
+
+namespace svm
+{
+    // Mapped Host Files
+    //
+    // Regions of local host files in the address spaces of processes. The
+    // page table entries of a region stay invalid until the page fault
+    // handler reads the page from the file into a frame. Pages are written
+    // back when the region is unmapped or the process exits, only the ones
+    // that differ from the file. Files are given on the command line and
+    // referred to by their number
+    class FileMappings
+    {
+        public:
+            typedef Memory::page_table_size_type page_type;
+
+            // `mmap` takes the file number in the low bits of `a` and the
+            //   first page of the region in the file above them
+            static const unsigned int FILE_BITS = 8;
+            static const unsigned int MAX_FILES = 1 << FILE_BITS;
+
+            struct Mapping
+            {
+                Process::process_id_type process_id;
+                unsigned int file;
+                page_type first_page;  // In the address space
+                page_type pages_count;
+                page_type file_page;   // In the file
+            };
+
+            std::vector<Mapping> mappings; // Of all processes
+
+            FileMappings();
+
+            // Opens the files for reading and writing, the numbers follow
+            //   the order of `paths`
+            bool Open(const std::vector<std::string> &paths);
+
+            unsigned int GetFilesCount() const;
+            // Pages of a file, the last one may be partial
+            page_type GetFilePagesCount(unsigned int file) const;
+
+            // Region of a process that contains `page`, NULL if none
+            const Mapping *Find(
+                               Process::process_id_type process_id,
+                               page_type page
+                           ) const;
+            bool Overlaps(
+                     Process::process_id_type process_id,
+                     page_type first_page,
+                     page_type pages_count
+                 ) const;
+
+            // A page of a region into `PAGE_SIZE` words, words past the end
+            //   of the file read as zeros
+            bool ReadPage(const Mapping &mapping, page_type page, int *words);
+            // Writes a page back if it changed, words past the end of the
+            //   file are dropped
+            bool WritePage(
+                     const Mapping &mapping,
+                     page_type page,
+                     const int *words
+                 );
+
+            void Write(Checkpoint::Writer &writer) const;
+            // Reads the regions into `restored`, the kernel replaces
+            //   `mappings` once the whole checkpoint was read
+            bool Read(
+                     Checkpoint::Reader &reader,
+                     std::vector<Mapping> &restored
+                 ) const;
+
+        private:
+            std::deque<std::fstream> _files;
+            std::vector<std::streamoff> _sizes; // In words
+
+            bool Seek(
+                     const Mapping &mapping,
+                     page_type page,
+                     std::streamsize &words_count
+                 );
+    };
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "checkpoint.h"
+#include "memory.h"
+#include "process.h"
+
+namespace svm
+{
+    // Interprocess Communication State
+    //
+    // Shared segments are sets of frames mapped into the page tables of
+    // every process that attached them. Messages are frames taken out of
+    // the page table of the sender and put into the one of the receiver,
+    // so whole pages move without copying a word. The kernel implements
+    // the system calls on top of this state
+    class IPC
+    {
+        public:
+            typedef int key_type;
+            typedef std::vector<Memory::page_entry_type> frames_type;
+
+            struct Segment
+            {
+                frames_type frames;
+                unsigned int attachments; // Processes that mapped it, the
+                                          //   frames are freed at 0
+
+                Segment();
+            };
+
+            // Queued messages are descriptors in kernel memory (from a
+            //   `SlabCache`): the number of pages, then their frames.
+            //   Unused frame words are INVALID_PAGE
+            static const Memory::ram_size_type MAX_MESSAGE_PAGES = 30;
+            static const Memory::ram_size_type MESSAGE_SIZE =
+                MAX_MESSAGE_PAGES + 1;
+
+            struct Mailbox
+            {
+                std::deque<Memory::ram_size_type> messages;
+                // Blocked processes in the order they asked, the target
+                //   address and the capacity are in their saved `b`, `c`
+                std::deque<Process::process_id_type> receivers;
+            };
+
+            std::map<key_type, Segment> segments;
+            std::map<Memory::page_entry_type, key_type> shared_frames;
+            std::map<key_type, Mailbox> mailboxes;
+
+            // Number of processes blocked in `receive`
+            std::size_t CountReceivers() const;
+
+            void Write(Checkpoint::Writer &writer) const;
+            // Frames at or past `frames_count` (the frames of RAM) are
+            //   rejected
+            bool Read(
+                     Checkpoint::Reader &reader,
+                     Memory::page_table_size_type frames_count
+                 );
+
+        private:
+            static void WriteFrames(
+                            Checkpoint::Writer &writer,
+                            const frames_type &frames
+                        );
+            static bool ReadFrames(
+                            Checkpoint::Reader &reader,
+                            Memory::page_table_size_type frames_count,
+                            frames_type &frames
+                        );
+    };
+}
+
+#endif
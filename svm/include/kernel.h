@@ -1,12 +1,23 @@
 #ifndef KERNEL_H
 #define KERNEL_H
 
+#include <csignal>
 #include <deque>
-#include <queue>
 #include <string>
+#include <thread>
 
 #include "board.h"
+#include "checkpoint.h"
+#include "event_log.h"
+#include "executable.h"
+#include "file_mappings.h"
+#include "ipc.h"
+#include "profiler.h"
 #include "process.h"
+#include "slab.h"
+#include "swap_space.h"
+#include "syscalls.h"
+#include "timer_wheel.h"
 
 namespace svm
 {
@@ -23,29 +34,152 @@ namespace svm
                 Priority
             };
 
+            // Boot parameters taken from the command line
+            struct Options
+            {
+                static const Board::cycles_type
+                    DEFAULT_CHECKPOINT_INTERVAL = 1000000;
+
+                std::string disk_image_path; // Backing file of the disk,
+                                             //   no disk if empty
+
+                std::string checkpoint_path; // Periodic checkpoints, none
+                                             //   if empty
+                Board::cycles_type checkpoint_interval;
+                std::string restore_path;    // Checkpoint to resume from
+
+                std::string record_path;     // Event log to write
+                std::string replay_path;     // Event log to reproduce
+
+                std::string profile_path;    // Guest profile output, no
+                                             //   profiling if empty
+                unsigned int profile_interval;
+                unsigned int profile_stack_depth;
+
+                bool verify;                 // Verify programs at load
+                                             //   and run them unchecked
+
+                std::string trace_path;      // Binary event trace, no
+                                             //   tracing if empty
+                Trace::Levels trace_level;
+
+                std::string input_path;      // Host input on IRQ 1 ("-" is
+                                             //   the standard input), no
+                                             //   input if empty
+
+                std::vector<std::string>
+                    mapped_file_paths;       // Files for `mmap` in the order
+                                             //   of their numbers
+
+                Cache::Config cache;         // No cache model without L1
+
+                Options();
+            };
+
+            // Events a host embedding the machine may stop a run at, the
+            //   board stops at the end of the cycle
+            enum Events
+            {
+                NoEvents     = 0,
+                ProcessExit  = 1 << 0,
+                Syscall      = 1 << 1,
+                PageFault    = 1 << 2,
+                DeadlineMiss = 1 << 3
+            };
+
+            enum RunResults
+            {
+                CyclesElapsed, // The cycles of the run are over
+                EventOccurred, // `last_events` stopped the run
+                Stopped        // Nothing left to run, or the kernel gave
+                               //   up (out of memory, every process waits
+                               //   for a message, paused)
+            };
+
+            // Counters the statistics are printed from
+            struct Statistics
+            {
+                unsigned long long page_faults;
+                unsigned long long compacted_blocks;
+                unsigned long long compacted_words;
+                unsigned long long swapped_out_pages;
+                unsigned long long swapped_in_pages;
+                unsigned long long suspensions;
+                unsigned long long realtime_jobs;
+                unsigned long long deadline_misses;
+
+                Statistics();
+            };
+
             typedef std::deque<Process> process_list_type;
-            typedef std::priority_queue<Process> process_priorities_type;
 
             Board board;
 
+            // Ready processes (and the running one). The Priority scheduler
+            //   keeps them as a max-heap with the running process on top
             process_list_type processes;
-            process_priorities_type priorities;
+            // Processes waiting for a device
+            process_list_type blocked;
+            // Processes swapped out while the frames were overcommitted
+            process_list_type suspended;
+            // Ready real-time processes, a heap by deadline with the running
+            //   one on top. They run ahead of the normal class
+            process_list_type realtime;
 
             Scheduler scheduler;
 
-            // Kernel page table (used to allocate processes)
-            Memory::page_table_type *page_table;
+            // Kernel page table, a direct map of RAM (active while the CPU
+            //   is idle)
+            Memory::page_table_type page_table;
 
-            // Kernel boot process (setup ISRs, create processes, etc.)
+            // Set by `Run` when events stopped it, a mask of the events of
+            //   the last cycle (`exit` is a syscall and a process exit) and
+            //   the process of the first one
+            unsigned int last_events;
+            Process::process_id_type last_event_process_id;
+
+            // Kernel boot process (setup ISRs, create processes, etc.), the
+            //   machine starts with `Run`
             Kernel(
                 Scheduler scheduler,
-                std::vector<Memory::ram_type> executables_paths
+                std::vector<Memory::ram_type> executables_paths,
+                const Options &options = Options()
             );
 
             virtual ~Kernel();
 
+            // Runs until nothing is left, prints the statistics and closes
+            //   the output files (the `svm` command line)
+            void Run();
+            // Runs at most `cycles` cycles and stops early at the events in
+            //   the `events` mask. Calls continue where the last one
+            //   stopped
+            RunResults Run(
+                           Board::cycles_type cycles,
+                           unsigned int events = NoEvents
+                       );
+            bool IsFinished() const;
+            // Writes the profile, closes the trace and the event log. The
+            //   destructor calls it if nobody did
+            void Shutdown();
+
+            // Submits an image from memory at any time, the CPU takes it
+            //   right away if it was idle
+            void Load(const Memory::ram_type &executable);
+
+            Statistics GetStatistics() const;
+
+            // Admits a process now or holds it back until its frames are
+            //   free
+            void SubmitProcess(Memory::ram_type &executable);
+
             // Creates a new PCB, places the executable image into memory
-            void CreateProcess(Memory::ram_type &executable);
+            //   (raw code or the SVM object format). `program` is the parsed
+            //   header of the image, the segments are mapped from it
+            void CreateProcess(
+                     const Memory::ram_type &executable,
+                     const Executable &program
+                 );
 
             // Allocates `units` of memory for kernel data. Returns an
             // address on success or NO_FREE_LARGE_ENOUGH_BLOCK on failure
@@ -64,17 +198,333 @@ namespace svm
             //
 
         private:
-			Memory::ram_size_type Translate(Memory::ram_size_type virtual_address);
+            // Held back images, the header is parsed once at the submission
+            struct Arrival
+            {
+                Memory::ram_type image;
+                Executable program;
+            };
+            typedef std::deque<Arrival> arrival_list_type;
+
 			bool TryPageFault();
-			
+
+            // Translates an address of a process that may not be current,
+            //   maps a frame on demand. Returns INVALID_PAGE when out of
+            //   frames
+            Memory::ram_size_type TranslateProcessAddress(
+                                      const Process &process,
+                                      Memory::vmem_size_type virtual_address
+                                  );
+
+            // Maps the data and bss segments into the page table of a new
+            //   process, then bss and `static_pages` up to the working set
+            //   hint. Returns false when out of frames
+            bool MapSegments(
+                     Process &process,
+                     const Executable &program,
+                     const Memory::ram_type &image,
+                     const std::vector<Memory::page_table_size_type> &static_pages
+                 );
+            // Gives the kernel memory and the frames of a process back
+            void ReleaseProcessMemory(Process &process);
+
+            Memory::page_entry_type AcquireZeroedFrame();
+            // A zeroed frame or a page of a mapped file for a page of the
+            //   process
+            Memory::page_entry_type AcquireProcessFrame(
+                                        const Process &process,
+                                        Memory::page_table_size_type page
+                                    );
+
+            // Frame allotments. Referenced bits are sampled into page ages
+            //   at the ticks, the working set is the pages used within the
+            //   window. Page faults adjust the allotment by their frequency,
+            //   evicted pages go to the swap space
+            Memory::page_table_size_type GetInitialAllotment(
+                                             const Executable &program
+                                         );
+            Memory::page_table_size_type CountResidentPages(
+                                             const Process &process
+                                         );
+            Memory::page_table_size_type CountWorkingSet(
+                                             const Process &process
+                                         );
+            unsigned int GetFrameAge(Memory::page_entry_type frame);
+            // Free frames less the ones promised to processes, negative
+            //   when the allotments do not fit
+            long long CountUnreservedFrames();
+            void UpdateAllotment(Process &process);
+            void EvictPage(Process &process, Memory::page_table_size_type page);
+            bool EvictOldestPage(Process &process);
+            // Takes a page from another ready process, false if none has one
+            bool ReclaimFrame(const Process &requester);
+            void SampleWorkingSets();
+
+            // Load control: suspends processes while the system thrashes,
+            //   resumes them and admits the held back ones when frames are
+            //   free. Returns true if a process became ready
+            void ControlLoad();
+            void SuspendProcess(process_list_type::size_type index);
+            // The ready process with the lowest priority, the newest of them
+            process_list_type::size_type FindSuspensionVictim();
+            bool AdmitProcesses(bool force);
+
+            // Scheduling primitives shared by all schedulers
+            Process &CurrentProcess();
+            void SaveCurrentProcess(Process::States state);
+            // Charges the cycles and the instructions since the dispatch
+            void ChargeCurrentProcess();
+            void SwitchToCurrentProcess();
+            void EnqueueProcess(Process &process);
+            void RemoveCurrentProcess();
+
+            void TerminateCurrentProcess();
+            void BlockCurrentProcess();
+            void UnblockProcess(process_list_type::iterator process);
+
+            // Disk system calls and the completion interrupt
+            void SubmitDiskRequest(Disk::Operations operation);
+            void CompleteDiskRequests();
+
+            // Vectored system call
+            void SubmitBatch();
+
+            // Host input system call and IRQ 1. Reads return the number of
+            //   words, 0 at the end of the input
+            void ReadInput();
+            void CompleteInputReads();
+            int DeliverInput(
+                    Process &process,
+                    Memory::vmem_size_type buffer,
+                    int capacity
+                );
+            void RecordInput(const Memory::ram_type &words);
+
+            // Sleep and timeouts of blocking calls on the timer wheel. A
+            //   call that times out returns TIMED_OUT
+            enum TimerKinds
+            {
+                SleepTimer,
+                ReceiveTimer,
+                InputTimer,
+                ReleaseTimer
+            };
+
+            static const int TIMED_OUT = -2;
+
+            void Sleep();
+            void SetTimeout();
+            // False when there is no kernel memory for the timer
+            bool ArmTimeout(Process &process, TimerKinds kind);
+            void ExpireTimers();
+
+            // Copies the performance counters of the calling process to
+            //   the buffer at 'a': instructions, page faults, context
+            //   switches and cycles on the CPU, the low 32 bits of each.
+            //   Returns the number of words or -1
+            void ReadCounters();
+
+            // Earliest deadline first real-time class. A process joins it
+            //   if the densities of all real-time processes stay within
+            //   the CPU. It waits for the next release when a job is done
+            //   or its budget runs out
+            void SetRealtime();
+            void WaitForNextPeriod();
+            // Releases the jobs whose period has started, counts the
+            //   misses of the unfinished ones. Returns true if a job was
+            //   released
+            bool ReleaseJobs(Process &process);
+            void EnforceBudgets();
+            static bool HasLaterDeadline(
+                            const Process &process,
+                            const Process &another_process
+                        );
+
+            // Mapped host files. Unmapping writes the changed pages back,
+            //   returns false if that failed
+            void MapFile();
+            void UnmapFile();
+            bool UnmapRegion(
+                     Process &process,
+                     std::vector<FileMappings::Mapping>::iterator mapping
+                 );
+
+            // Shared segments and page-remapping messages
+            bool GetPageRange(
+                     const Process &process,
+                     Memory::page_table_size_type &first_page,
+                     Memory::page_table_size_type &pages_count
+                 );
+            void AttachSharedSegment();
+            void SendMessage();
+            void ReceiveMessage();
+            // Puts the frames of a message into a page table and frees the
+            //   descriptor, returns the number of pages
+            int MapMessage(
+                    Process &process,
+                    Memory::vmem_size_type virtual_address,
+                    Memory::ram_size_type message
+                );
+
+            // Online heap compaction. Once the free words outside of the
+            //   largest hole cross the threshold, the timer slides process
+            //   images down into the lowest hole, one block per tick as the
+            //   word budget allows. Other kernel blocks are pinned
+            void UpdateFragmentation();
+            void CompactMemoryStep();
+            Process *FindProcessByImage(Memory::ram_size_type address);
+
+            // Tickless idle: the distance to the closest pending event
+            Board::cycles_type CyclesUntilNextEvent();
+
+            // Stops the board at the end of the cycle if the host asked for
+            //   the event
+            void StopAtEvent(Events event, Process::process_id_type process_id);
+            // Stops the board for good
+            void StopMachine();
+            // Board alarm: admits the replayed images that are due and takes
+            //   the periodic checkpoint, then arms it for the closest one
+            void Alarm();
+            void ArmAlarm();
+
+            void PrintStatistics();
+            // Hits and misses of every process that used the cache model
+            void PrintCacheStatistics();
+
+            // Checkpoints. The image is taken on the board thread between
+            //   two cycles and written to the file in the background
+            void SaveCheckpoint();
+            bool RestoreCheckpoint(const std::string &path);
+
+            bool ReadPageTable(
+                     Checkpoint::Reader &reader,
+                     Memory::page_table_type &page_table
+                 );
+            void WriteProcesses(
+                     Checkpoint::Writer &writer,
+                     const process_list_type &process_list
+                 );
+            // A restore reads everything into scratch state before the
+            //   machine changes
+            bool ReadProcesses(
+                     Checkpoint::Reader &reader,
+                     process_list_type &process_list
+                 );
+            bool ReadInputReaders(
+                     Checkpoint::Reader &reader,
+                     std::deque<Process::process_id_type> &input_readers
+                 );
+            bool ReadArrivals(
+                     Checkpoint::Reader &reader,
+                     arrival_list_type &arrivals
+                 );
+            // The frame allocator, then the frames that were in use
+            bool ReadFreeFrames(
+                     Checkpoint::Reader &reader,
+                     std::vector<Memory::page_entry_type> &free_frames
+                 );
+            bool ReadFrames(Checkpoint::Reader &reader, Memory::ram_type &ram);
+
+            static void InterruptHandler(int signal);
+
+            // Profiler sampling channel handler
+            void SampleCurrentProcess();
+
             static const unsigned int _MAX_CYCLES_BEFORE_PREEMPTION = 100;
 
+            // Lower part of RAM is the kernel heap, frames above it are
+            //   given to processes. Kernel addresses are physical
+            static const Memory::ram_size_type _KERNEL_MEMORY_SIZE =
+                Memory::DEFAULT_RAM_SIZE / 2;
+
             Process::process_id_type _last_issued_process_id;
             Memory::ram_type::size_type _last_ram_position;
 
             unsigned int _cycles_passed_after_preemption;
             process_list_type::size_type _current_process_index;
-			
+
+            unsigned int _stop_events; // Mask of `Events` of the run
+            bool _stopped; // By the kernel, `Run` does not continue
+            bool _shut_down;
+
+            std::string _profile_path;
+
+            std::string _checkpoint_path;
+            Board::cycles_type _checkpoint_interval;
+            Board::cycles_type _checkpoint_cycle; // Of the next one
+            std::thread _checkpoint_writer;
+
+            static volatile std::sig_atomic_t _interrupted;
+
+            EventLog _event_log;
+            // Recorded completions of the requests in flight, in the
+            //   submission order
+            std::deque<EventLog::Event> _replayed_disk_completions;
+            // Images loaded after the boot of the recorded run, in order
+            std::deque<EventLog::Event> _replayed_admissions;
+
+            Profiler _profiler;
+
+            IPC _ipc;
+
+            bool _verify;
+
+            SyscallTable _syscalls;
+
+            // Kernel objects in kernel memory
+            SlabCache _message_cache;
+            SlabCache _page_table_cache;
+            SlabCache _pcb_cache;
+
+            // Where the running batch entry wants its result, INVALID_PAGE
+            //   outside of `SubmitBatch`
+            Memory::ram_size_type _batch_result_address;
+
+            unsigned long long _page_faults;
+
+            static const Memory::ram_size_type _COMPACTION_WORDS_PER_TICK = 16;
+            static const Memory::ram_size_type _FRAGMENTATION_THRESHOLD = 25; // %
+
+            bool _compacting;
+            Memory::ram_size_type _compaction_credit;
+            unsigned long long _compacted_words;
+            unsigned long long _compacted_blocks;
+
+            // Processes blocked in `input`, in the order they asked
+            std::deque<Process::process_id_type> _input_readers;
+
+            TimerWheel _timers;
+            std::vector<TimerWheel::Expired> _expired_timers; // Reused by
+                                                             //   every tick
+
+            FileMappings _mappings;
+
+            static const Memory::page_table_size_type _MIN_ALLOTMENT = 4;
+            static const Board::cycles_type _PFF_FAULT_GAP = 200; // CPU cycles
+            static const Board::cycles_type _WORKING_SET_SAMPLE_INTERVAL = 100;
+            static const unsigned int _WORKING_SET_WINDOW = 8; // Samples
+            static const Board::cycles_type _LOAD_CONTROL_INTERVAL = 1000;
+            static const unsigned long long _THRASHING_FAULTS = 20; // In an
+                                                                    //   interval
+
+            SwapSpace _swap;
+            arrival_list_type _arrivals;
+            std::vector<unsigned char> _frame_ages; // Samples since the last
+                                                    //   reference
+            Board::cycles_type _dispatch_cycle;
+            unsigned long long _dispatch_instructions; // CPU count then
+            Board::cycles_type _last_sample_cycle;
+            Board::cycles_type _last_control_cycle;
+            unsigned long long _control_faults; // At the last control
+            bool _out_of_frames; // The current process could not get one
+            unsigned long long _swapped_out_pages;
+            unsigned long long _swapped_in_pages;
+            unsigned long long _suspensions;
+
+            bool _running_realtime; // The CPU runs the top of `realtime`
+            unsigned long long _realtime_jobs;
+            unsigned long long _deadline_misses;
+
 			//for AllocateMemory and FreeMemory methods
 			Memory::ram_size_type _last_free_block_index;
 			const Memory::ram_size_type NO_FREE_LARGE_ENOUGH_BLOCK = -1;
@@ -0,0 +1,93 @@
+#ifndef KEYBOARD_H
+#define KEYBOARD_H
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "memory.h"
+#include "pic.h"
+
+namespace svm
+{
+    // Host Input Device (Keyboard)
+    //
+    // A host thread reads a file, a FIFO or the standard input and pushes
+    // every byte as a word into a single-producer/single-consumer ring.
+    // The board thread only loads the ring indices, it never locks or
+    // waits on this path. New input becomes visible at the next tick,
+    // which raises IRQ 1, and so does the end of the input
+    class Keyboard
+    {
+        public:
+            typedef unsigned long long cycles_type;
+
+            static const std::size_t RING_CAPACITY = 0x1000; // Power of 2
+
+            Keyboard(PIC &pic, const cycles_type *clock);
+            virtual ~Keyboard();
+
+            // Starts the reader thread, "-" is the standard input
+            bool Open(const std::string &path);
+            bool IsOpen() const;
+
+            // Takes the next visible word
+            bool TryRead(int &word);
+            // The input ended and every word was read
+            bool IsAtEnd() const;
+
+            // Replay: the words become visible at the recorded cycle
+            //   instead of coming from the host, no words with an end
+            void Schedule(
+                     cycles_type cycle,
+                     const Memory::ram_type &words
+                 );
+            // Cycles left before the next scheduled input, 0 if none
+            cycles_type CyclesUntilNextInput() const;
+
+            // Idle helper, sleeps a moment unless input is pending
+            void WaitForInput() const;
+
+            void Tick(); // Raises isr_1 when input becomes visible
+
+        private:
+            Keyboard(const Keyboard &);
+            Keyboard &operator=(const Keyboard &);
+
+            void Work(); // Reader thread body
+
+            struct Input
+            {
+                cycles_type cycle;
+                Memory::ram_type words;
+                Memory::ram_type::size_type position;
+            };
+
+            int _descriptor;
+            std::thread _reader;
+            bool _open;
+
+            // Reader thread -> board thread
+            std::vector<int> _ring;
+            std::atomic<std::size_t> _head; // Next slot to write
+            std::atomic<std::size_t> _tail; // Next slot to read
+            std::atomic<bool> _ended;
+            std::atomic<bool> _stopping;
+
+            // Board thread only
+            std::size_t _visible_head;
+            bool _visible_end;
+            bool _end_notified;
+
+            bool _replaying;
+            std::deque<Input> _scheduled;
+            bool _scheduled_notified; // IRQ raised for the front one
+
+            PIC &_pic;
+            const cycles_type *_clock;
+    };
+}
+
+#endif
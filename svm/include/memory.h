@@ -1,6 +1,7 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <cstddef>
 #include <vector>
 #include <list>
 #include <utility>
@@ -18,8 +19,12 @@ namespace svm
             typedef ram_size_type vmem_size_type;
             typedef vmem_size_type page_entry_type;
 
-            typedef std::vector<page_entry_type>  page_table_type; //vector<int>
-            typedef page_table_type::size_type page_table_size_type;
+            // Page tables are words of kernel memory at a physical address
+            //   (the kernel heap is direct-mapped, so the kernel indexes
+            //   them like any RAM). An entry holds the frame of a page or
+            //   INVALID_PAGE, stored as -1
+            typedef ram_size_type page_table_type;
+            typedef ram_size_type page_table_size_type;
 
             typedef std::pair<page_table_size_type, ram_size_type>
                 page_index_offset_pair_type;
@@ -28,16 +33,43 @@ namespace svm
             static const ram_size_type PAGE_SIZE        = 0x80;    // 128 B
             static const ram_size_type INVALID_PAGE     = -1;
 
+            // Entries of a table, one per page of an address space
+            static const page_table_size_type PAGE_TABLE_SIZE =
+                DEFAULT_RAM_SIZE / PAGE_SIZE;
+
             ram_type ram; // physical memory as a fixed size array
-            page_table_type* page_table; // current process's page table used to
-                                         //   translate virtual addresses to
-                                         //   physical
+            page_table_type page_table; // current process's page table used to
+                                        //   translate virtual addresses to
+                                        //   physical
+            std::vector<unsigned char> referenced; // Per frame, set on every
+                                                   //   access through a page
+                                                   //   table, cleared by the
+                                                   //   kernel
 
             Memory();
             virtual ~Memory();
 
-            // Creates an empty page table for a process or the kernel
-            static page_table_type* CreateEmptyPageTable();
+            // Invalidates every entry of a page table for a process or the
+            //   kernel
+            void ClearPageTable(page_table_type page_table);
+            // Maps every page to the frame with the same index (the kernel
+            //   address space)
+            void MapDirectly(page_table_type page_table);
+            // Entries of a page table, pages past `PAGE_TABLE_SIZE` throw
+            //   std::out_of_range
+            page_entry_type GetPageEntry(
+                                page_table_type page_table,
+                                page_table_size_type page
+                            ) const;
+            void SetPageEntry(
+                     page_table_type page_table,
+                     page_table_size_type page,
+                     page_entry_type frame
+                 );
+            // Frames mapped in a page table
+            page_table_size_type CountMappedPages(
+                                     page_table_type page_table
+                                 ) const;
             // Translates a virtual address into an index of a page table and an
             // offset in the physical address space
             page_index_offset_pair_type
@@ -49,6 +81,15 @@ namespace svm
             page_entry_type AcquireFrame();
             // Releases a frame into a pool of free frames
             void ReleaseFrame(page_entry_type page);
+            page_table_size_type GetFreeFramesCount() const;
+            // Removes frames below `first_free_frame` from the pool (they
+            //   are owned by the kernel)
+            void ReserveFrames(page_entry_type first_free_frame);
+
+            // State of the frame allocator for checkpoints (from the bottom
+            //   of the pool to the top)
+            std::vector<page_entry_type> GetFreeFrames() const;
+            void SetFreeFrames(const std::vector<page_entry_type> &free_frames);
 
         private:
 		
@@ -13,19 +13,22 @@ namespace svm
     {
         public:
             typedef std::function<void()> isr_type;
+            typedef std::function<void(int)> syscall_type;
 
             // Hardware Interrupts (interrupt service routines that are
             //  called for incoming hardware events)
 
             isr_type isr_0; // IRQ 0: Timer
             isr_type isr_1; // IRQ 1: Keyboard
-            isr_type isr_2; // IRQ 2: ...TBD
+            isr_type isr_2; // IRQ 2: Disk
 
             // Software Interrupts (interrupt service routines that are
-            //  called by executing the 'int' CPU instruction)
+            //  called by the CPU itself)
+
+            syscall_type syscall; // 'int' instruction, gets its operand
 
             isr_type isr_3; // The kernel should decide how to use them
-            isr_type isr_4;
+            isr_type isr_4; // Page fault
             isr_type isr_5;
             isr_type isr_6;
             isr_type isr_7;
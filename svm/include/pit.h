@@ -1,6 +1,8 @@
 #ifndef PIT_H
 #define PIT_H
 
+#include <functional>
+
 #include "pic.h"
 
 namespace svm
@@ -15,13 +17,29 @@ namespace svm
 
             frequency_type frequency;
 
+            // Second channel for the profiler, not visible to guests.
+            //   Calls `sample` every `sampling_frequency` cycles, 0 turns
+            //   the channel off
+            frequency_type sampling_frequency;
+            std::function<void()> sample;
+
             PIT(PIC &pic);
             virtual ~PIT();
 
             void Tick(); // Calls isr_0 periodically
 
+            // Moves both counters forward without raising the interrupts
+            //   or the samples that fall into the skipped cycles (tickless
+            //   idle)
+            void FastForward(unsigned long long cycles);
+
+            // Counter state for checkpoints
+            frequency_type GetPassedCyclesCount() const;
+            void SetPassedCyclesCount(frequency_type passed_cycles_count);
+
         private:
             frequency_type _passed_cycles_count;
+            frequency_type _passed_sampling_cycles_count;
 
             PIC &_pic;
     };
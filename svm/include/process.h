@@ -3,6 +3,7 @@
 
 #include "cpu.h"
 #include "memory.h"
+#include "timer_wheel.h"
 
 namespace svm
 {
@@ -14,21 +15,56 @@ namespace svm
         public:
             enum States
             {
-                Running, Ready, Blocked
+                Running, Ready, Blocked, Suspended
             };
 
             typedef unsigned int process_id_type;
             typedef unsigned short process_priority_type;
 
+            // Words of the record with the saved registers: a, b, c,
+            //   flags, ip and sp
+            static const Memory::ram_size_type PCB_RECORD_SIZE = 6;
+
             process_id_type id;
-            Registers registers;
+            Memory::ram_size_type pcb; // Record in kernel memory, from the
+                                       //   cache of the kernel
             States state;
             process_priority_type priority;
 
             Memory::ram_size_type memory_start_position;
             Memory::ram_size_type memory_end_position;
             Memory::ram_size_type sequential_instruction_count;
-            Memory::page_table_type *page_table;
+            Memory::page_table_type page_table; // In kernel memory, from the
+                                                //   cache of the kernel
+            bool verified; // The text passed the `Verifier`
+            unsigned int pending_requests; // Batched disk requests in flight
+
+            int timeout; // Cycles `receive` and `input` wait at most, 0
+                         //   waits forever
+            TimerWheel::timer_id_type timer; // Sleep or timeout while
+                                             //   blocked
+
+            Memory::page_table_size_type allotment; // Frames it may hold
+            unsigned long long run_cycles; // Time on the CPU
+            unsigned long long fault_time; // `run_cycles` at the last fault
+
+            // Performance counters, `run_cycles` and `instructions` are
+            //   charged when the process leaves the CPU
+            unsigned long long instructions;
+            unsigned long long page_faults;
+            unsigned long long context_switches; // Dispatches
+
+            // Real-time class, `period` is 0 in the normal one. A job is
+            //   released every period with `budget` cycles of CPU time and
+            //   a deadline `relative_deadline` cycles after the release
+            unsigned long long period;
+            unsigned long long relative_deadline;
+            unsigned long long budget;
+            unsigned long long release;  // Of the next job
+            unsigned long long deadline; // Of the current job
+            unsigned long long job_start; // `run_cycles` at the release
+            bool job_done;
+            unsigned long long deadline_misses;
 
             Process(
                 process_id_type id,
@@ -38,6 +74,13 @@ namespace svm
 
             virtual ~Process();
 
+            // Registers of the process while it is off the CPU
+            Registers LoadRegisters(const Memory &memory) const;
+            void StoreRegisters(
+                     Memory &memory,
+                     const Registers &registers
+                 ) const;
+
             bool operator<(const Process &anotherProcess) const;
     };
 }
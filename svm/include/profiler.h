@@ -0,0 +1,84 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "memory.h"
+
+namespace svm
+{
+    // Sampling Guest Profiler
+    //
+    // The kernel fills samples from the PIT sampling channel. Samples go to
+    // a preallocated ring that is folded into the totals only when it is
+    // full or the profile is saved, so taking a sample never allocates
+    class Profiler
+    {
+        public:
+            typedef unsigned int process_id_type;
+            typedef std::vector<int>::size_type capacity_type;
+
+            static const unsigned int MAX_STACK_DEPTH = 16;
+            static const capacity_type DEFAULT_CAPACITY = 0x1000;
+
+            // A prime interval does not alias with the scheduler quantum or
+            //   with guest loops
+            static const unsigned int DEFAULT_INTERVAL = 997;
+
+            struct Sample
+            {
+                process_id_type process_id;
+                Memory::ram_size_type offset; // `ip` relative to the image
+
+                // Return addresses read from the guest stack at `sp`,
+                //   innermost first
+                unsigned int depth;
+                Memory::ram_size_type stack[MAX_STACK_DEPTH];
+            };
+
+            unsigned int stack_depth; // Frames to read at `sp`, 0 for none
+
+            Profiler();
+            virtual ~Profiler();
+
+            void Start(capacity_type capacity, unsigned int stack_depth);
+            bool IsEnabled() const;
+
+            // Returns the slot for the next sample
+            Sample &NextSample();
+
+            // Keeps a copy of a program to annotate its samples
+            void AddImage(
+                     process_id_type process_id,
+                     const Memory::ram_type &image
+                 );
+
+            // Writes folded stacks for flamegraph tools to `path` and the
+            //   annotated per-ip histogram to `path`.ips
+            bool Save(const std::string &path);
+
+        private:
+            void Drain();
+            std::string DescribeFrame(
+                            process_id_type process_id,
+                            Memory::ram_size_type offset
+                        );
+
+            std::vector<Sample> _samples;
+            capacity_type _samples_count;
+            bool _enabled;
+
+            unsigned long long _total_samples_count;
+            std::map<std::string, unsigned long long> _folded_stacks;
+            std::map<
+                std::pair<process_id_type, Memory::ram_size_type>,
+                unsigned long long
+            > _histogram;
+            std::map<process_id_type, Memory::ram_type> _images;
+    };
+}
+
+#endif
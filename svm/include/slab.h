@@ -0,0 +1,91 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <functional>
+
+#include "checkpoint.h"
+#include "memory.h"
+
+namespace svm
+{
+    // Kernel Object Cache (Slab Allocator)
+    //
+    // Objects of one size are carved from page-sized slabs taken from the
+    // kernel heap, objects larger than a page take slabs of the fewest
+    // pages that hold one. Free objects of a slab are linked through a
+    // word before each object, and slabs with free objects are linked
+    // through their headers, so allocation and release never search. The
+    // constructor runs once per object when its slab is carved, users give
+    // objects back in the constructed state. Completely free slabs beyond
+    // the first one go back to the heap.
+    //
+    // The kernel keeps IPC message descriptors, page tables, timer wheel
+    // nodes and the saved registers of processes in caches
+    class SlabCache
+    {
+        public:
+            typedef std::function<
+                        Memory::ram_size_type(Memory::ram_size_type)
+                    > allocate_type;
+            typedef std::function<void(Memory::ram_size_type)> free_type;
+            typedef std::function<void(Memory::ram_size_type)>
+                constructor_type;
+
+            static const Memory::ram_size_type NO_OBJECT = -1;
+
+            // Slab header words: next and previous slab with free objects,
+            //   free objects count, first free object
+            static const Memory::ram_size_type SLAB_HEADER_SIZE = 4;
+
+            // `object_size` words are available to the user, two more
+            //   words before each object keep its slab and the free list
+            SlabCache(
+                Memory &memory,
+                Memory::ram_size_type object_size,
+                allocate_type allocate,
+                free_type free,
+                constructor_type constructor
+            );
+
+            // Physical address of a constructed object, NO_OBJECT when
+            //   the heap is full
+            Memory::ram_size_type Allocate();
+            void Free(Memory::ram_size_type object);
+
+            Memory::ram_size_type GetObjectSize() const;
+            Memory::ram_size_type GetSlabSize() const;
+            Memory::ram_size_type GetObjectsPerSlab() const;
+            Memory::ram_size_type GetSlabsCount() const;
+            Memory::ram_size_type GetAllocatedObjectsCount() const;
+
+            // The slabs are in RAM, only the list heads are written. A
+            //   restore reads into a copy and assigns it once the whole
+            //   checkpoint was read, both caches must be over one memory
+            void Write(Checkpoint::Writer &writer) const;
+            bool Read(Checkpoint::Reader &reader);
+            SlabCache(const SlabCache &other);
+            SlabCache &operator=(const SlabCache &other);
+
+        private:
+            bool Grow();
+
+            void Link(Memory::ram_size_type slab);
+            void Unlink(Memory::ram_size_type slab);
+
+            Memory &_memory;
+
+            Memory::ram_size_type _object_size;
+            Memory::ram_size_type _slab_size;
+            Memory::ram_size_type _objects_per_slab;
+
+            allocate_type _allocate;
+            free_type _free;
+            constructor_type _constructor;
+
+            Memory::ram_size_type _partial_slabs; // Slabs with free objects
+            Memory::ram_size_type _slabs_count;
+            Memory::ram_size_type _allocated_objects_count;
+    };
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SWAP_SPACE_H
+#define SWAP_SPACE_H
+
+#include <map>
+#include <utility>
+
+#include "checkpoint.h"
+#include "memory.h"
+#include "process.h"
+
+namespace svm
+{
+    // Backing Store
+    //
+    // Contents of the pages the kernel took away from processes, kept in
+    // the host memory until the page is faulted back in or the process
+    // exits. Zero pages are not stored, a page that is not here reads as
+    // zeros the same as a page that was never touched
+    class SwapSpace
+    {
+        public:
+            SwapSpace();
+
+            void Store(
+                     Process::process_id_type process_id,
+                     Memory::page_table_size_type page,
+                     const int *words
+                 );
+            // Fills `PAGE_SIZE` words and forgets the page, false if it is
+            //   not stored
+            bool Load(
+                     Process::process_id_type process_id,
+                     Memory::page_table_size_type page,
+                     int *words
+                 );
+
+            void Discard(
+                     Process::process_id_type process_id,
+                     Memory::page_table_size_type page
+                 );
+            // All pages of a process
+            void Discard(Process::process_id_type process_id);
+
+            std::size_t GetPagesCount() const;
+
+            void Write(Checkpoint::Writer &writer) const;
+            bool Read(Checkpoint::Reader &reader);
+
+        private:
+            typedef std::pair<
+                        Process::process_id_type,
+                        Memory::page_table_size_type
+                    > key_type;
+
+            std::map<key_type, Memory::ram_type> _pages;
+    };
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef SYSCALLS_H
+#define SYSCALLS_H
+
+#include <functional>
+#include <vector>
+
+#include "memory.h"
+
+namespace svm
+{
+    // System Call Table
+    //
+    // The operand of `int` selects a handler, the arguments are in `a`,
+    // `b`, `c` and the result is returned in `a`. The kernel registers the
+    // handlers at boot, the verifier accepts only registered numbers
+    class SyscallTable
+    {
+        public:
+            typedef std::function<void()> handler_type;
+
+            // `int` numbers
+            static const int EXIT       = 1,
+                             DISK_READ  = 2,
+                             DISK_WRITE = 3,
+                             SHARE      = 4,
+                             SEND       = 5,
+                             RECEIVE    = 6,
+                             BATCH      = 7,
+                             INPUT      = 8,
+                             SLEEP      = 9,
+                             TIMEOUT    = 10,
+                             MMAP       = 11,
+                             MUNMAP     = 12,
+                             REALTIME   = 13,
+                             NEXT_PERIOD = 14,
+                             COUNTERS   = 15;
+
+            /*
+             *   batch # Runs `b` entries at virtual address `a` in one
+             *         #   kernel entry
+             *
+             *   An entry is the number and the `a`, `b`, `c` arguments of
+             *   a call, the result replaces its `a` word. Disk requests of
+             *   a batch are all submitted before the process blocks, each
+             *   result is written when its request completes. Numbers that
+             *   may switch processes (`exit`, `send`, `receive`, `batch`,
+             *   `input`, `sleep`) get -1. Returns the number of entries or
+             *   -1
+             */
+            static const Memory::vmem_size_type BATCH_ENTRY_SIZE = 4;
+            static const Memory::vmem_size_type MAX_BATCH_ENTRIES = 64;
+
+            SyscallTable();
+
+            void Register(int number, handler_type handler, bool batchable);
+
+            bool IsRegistered(int number) const;
+            bool IsBatchable(int number) const;
+
+            // Returns false if nothing is registered for the number
+            bool Dispatch(int number) const;
+
+        private:
+            struct Entry
+            {
+                handler_type handler;
+                bool batchable;
+
+                Entry();
+            };
+
+            std::vector<Entry> _entries;
+    };
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "checkpoint.h"
+#include "memory.h"
+#include "slab.h"
+
+namespace svm
+{
+    // Hierarchical Timing Wheel
+    //
+    // Four levels of 256 slots, each slot of a level spans a whole turn of
+    // the level below. A timer goes into the lowest level that reaches its
+    // expiry and moves down a level when the wheel turns over its slot, so
+    // inserting and cancelling only link and unlink a node. Expired timers
+    // are collected a whole slot at a time. Nodes are objects of a slab
+    // cache in kernel memory and are referred to by their physical address,
+    // only the list heads are kept by the host
+    class TimerWheel
+    {
+        public:
+            typedef unsigned long long cycles_type;
+            typedef std::size_t timer_id_type;
+
+            static const timer_id_type NO_TIMER = static_cast<std::size_t>(-1);
+
+            static const unsigned int LEVELS    = 4;
+            static const unsigned int SLOT_BITS = 8;
+            static const unsigned int SLOTS     = 1 << SLOT_BITS;
+
+            struct Expired
+            {
+                unsigned int owner;
+                int kind;
+            };
+
+            // Slabs of nodes are taken from and given back to the heap
+            //   with `allocate` and `free`
+            TimerWheel(
+                Memory &memory,
+                SlabCache::allocate_type allocate,
+                SlabCache::free_type free
+            );
+
+            // `expiry` is an absolute cycle, past cycles expire at the next
+            //   tick. `owner` and `kind` are for the user. NO_TIMER when the
+            //   heap is full
+            timer_id_type Add(cycles_type expiry, unsigned int owner, int kind);
+            void Cancel(timer_id_type timer);
+
+            // Expires everything up to `now`, spans of empty levels are
+            //   skipped at once
+            void Advance(cycles_type now, std::vector<Expired> &expired);
+
+            // Cycles before the wheel may expire something: exact for the
+            //   lowest level, the next turn over of a higher level otherwise.
+            //   0 when there are no timers
+            cycles_type CyclesUntilNextExpiry() const;
+
+            std::size_t GetCount() const;
+
+            // The last cycle that was processed
+            cycles_type GetCurrentCycle() const;
+
+            // The nodes are in RAM, only the list heads are written. A
+            //   restore reads into a copy and assigns it once the whole
+            //   checkpoint was read, as for slab caches
+            void Write(Checkpoint::Writer &writer) const;
+            bool Read(Checkpoint::Reader &reader);
+            TimerWheel(const TimerWheel &other);
+            TimerWheel &operator=(const TimerWheel &other);
+
+        private:
+            cycles_type GetExpiry(timer_id_type timer) const;
+            timer_id_type GetField(timer_id_type timer, std::size_t field) const;
+            void SetField(
+                     timer_id_type timer,
+                     std::size_t field,
+                     timer_id_type value
+                 );
+
+            void Link(timer_id_type timer);
+            void Unlink(timer_id_type timer);
+            void Cascade(unsigned int level, std::size_t index);
+
+            Memory &_memory;
+            SlabCache _nodes;
+
+            std::vector<timer_id_type> _slots; // LEVELS * SLOTS list heads
+            std::size_t _level_counts[LEVELS];
+            std::size_t _count;
+
+            cycles_type _current;
+    };
+}
+
+#endif
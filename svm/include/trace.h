@@ -0,0 +1,133 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Events above this level are compiled out (0 compiles out everything)
+#ifndef SVM_TRACE_LEVEL
+#define SVM_TRACE_LEVEL 3
+#endif
+
+// Arguments are not evaluated unless the level is compiled in and enabled
+#define SVM_TRACE(trace, level, ...)                               \
+    do {                                                           \
+        if ((level) <= SVM_TRACE_LEVEL && (trace).IsEnabled(level)) { \
+            (trace).Record(__VA_ARGS__);                           \
+        }                                                          \
+    } while (false)
+
+namespace svm
+{
+    // Binary Event Tracing
+    //
+    // Every thread that records gets its own preallocated single-producer
+    // ring, so recording is a few stores and one release without locks or
+    // system calls. A background thread drains the rings into the file. A
+    // full ring drops the event and counts it instead of blocking the
+    // producer. `svmtrace` decodes the file
+    class Trace
+    {
+        public:
+            typedef unsigned long long cycles_type;
+
+            static const unsigned int MAGIC   = 0x544d5653; // "SVMT"
+            static const unsigned int VERSION = 1;
+
+            enum Levels
+            {
+                Off,
+                Errors,
+                Info,
+                Debug
+            };
+
+            enum Events
+            {
+                InvalidOpcode, // Errors, values: opcode, ip
+                OutOfMemory,   // Errors, values: page
+                PageFault,     // Info, values: page, frame
+                ContextSwitch, // Info, process: the next one, values: ip
+                Syscall,       // Debug, values: number, register `a`
+                Alloc,         // Debug, values: kernel address, words
+                Free,          // Debug, values: kernel address
+                Dropped,       // Errors, values: events lost to full rings
+                EventsCount
+            };
+
+            // Written to the file as is, 32 bytes
+            struct Event
+            {
+                cycles_type cycle;
+                unsigned int type;
+                unsigned int process_id;
+                long long values[2];
+            };
+
+            // `process_id` of events without a process
+            static const unsigned int KERNEL_PROCESS  = 0xFFFFFFFF;
+            // Events of the CPU, decoders take the process of the last
+            //   `ContextSwitch`
+            static const unsigned int CURRENT_PROCESS = 0xFFFFFFFE;
+
+            static const std::size_t DEFAULT_RING_CAPACITY = 0x4000;
+
+            Trace(const cycles_type *clock);
+            virtual ~Trace();
+
+            bool Start(const std::string &path, Levels level);
+            void Stop(); // Drains everything left and closes the file
+
+            bool IsEnabled(Levels level) const;
+
+            // Stamps the event with the current cycle of the clock
+            void Record(
+                     Events type,
+                     unsigned int process_id,
+                     long long value0 = 0,
+                     long long value1 = 0
+                 );
+
+        private:
+            Trace(const Trace &);
+            Trace &operator=(const Trace &);
+
+            struct Ring
+            {
+                std::thread::id owner;
+                std::vector<Event> events;
+                std::atomic<std::size_t> head; // Next slot to write
+                std::atomic<std::size_t> tail; // Next slot to drain
+                std::atomic<unsigned long long> dropped;
+
+                Ring(std::thread::id owner, std::size_t capacity);
+            };
+
+            Ring *GetRing();
+
+            void Drain();
+            bool DrainRings(); // Returns false if nothing was written
+
+            const cycles_type *_clock;
+            unsigned long long _instance;  // Keys the per-thread ring
+                                           //   cache, addresses are reused
+
+            std::atomic<int> _level;
+
+            std::mutex _rings_mutex;       // Taken when a thread records
+                                           //   the first time and by the
+                                           //   drain
+            std::vector<std::unique_ptr<Ring>> _rings;
+
+            std::ofstream _output;
+            std::atomic<bool> _stopping;
+            std::thread _drain;
+    };
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <vector>
+
+#include "memory.h"
+#include "syscalls.h"
+
+namespace svm
+{
+    // Load-time Program Verifier
+    //
+    // Proves that the text of a process only has known opcodes and
+    // registered system calls, jumps to instruction boundaries inside of the text,
+    // never runs past its end, and loads and stores at addresses the page
+    // table covers. The CPU runs verified processes without checking any
+    // of that per instruction
+    class Verifier
+    {
+        public:
+            struct Result
+            {
+                bool verified;
+
+                // Pages of the constant `ld`/`st` addresses, sorted. Block
+                //   instructions take addresses from registers and are not
+                //   included
+                std::vector<Memory::page_table_size_type> pages;
+
+                Result();
+            };
+
+            static Result Verify(
+                              const int *text,
+                              Memory::ram_size_type size,
+                              Memory::page_table_size_type page_table_size,
+                              const SyscallTable &syscalls
+                          );
+    };
+}
+
+#endif
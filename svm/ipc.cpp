@@ -0,0 +1,143 @@
+#include "ipc.h"
+
+namespace svm
+{
+    IPC::Segment::Segment()
+        : frames(),
+          attachments(0) { }
+
+    std::size_t IPC::CountReceivers() const
+    {
+        std::size_t receivers = 0;
+        for (auto &mailbox : mailboxes) {
+            receivers += mailbox.second.receivers.size();
+        }
+
+        return receivers;
+    }
+
+    void IPC::Write(Checkpoint::Writer &writer) const
+    {
+        writer.Write(static_cast<unsigned long long>(segments.size()));
+        for (auto &segment : segments) {
+            writer.Write(segment.first);
+            writer.Write(segment.second.attachments);
+            WriteFrames(writer, segment.second.frames);
+        }
+
+        writer.Write(static_cast<unsigned long long>(mailboxes.size()));
+        for (auto &mailbox : mailboxes) {
+            writer.Write(mailbox.first);
+
+            writer.Write(
+                static_cast<unsigned long long>(mailbox.second.messages.size())
+            );
+            for (auto message : mailbox.second.messages) {
+                writer.Write(message);
+            }
+
+            writer.Write(
+                static_cast<unsigned long long>(mailbox.second.receivers.size())
+            );
+            for (auto receiver : mailbox.second.receivers) {
+                writer.Write(receiver);
+            }
+        }
+    }
+
+    bool IPC::Read(
+                  Checkpoint::Reader &reader,
+                  Memory::page_table_size_type frames_count
+              )
+    {
+        segments.clear();
+        shared_frames.clear();
+        mailboxes.clear();
+
+        unsigned long long segments_count;
+        if (!reader.Read(segments_count)) {
+            return false;
+        }
+        for (unsigned long long i = 0; i < segments_count; ++i) {
+            key_type key;
+            Segment segment;
+            if (!reader.Read(key) ||
+                    !reader.Read(segment.attachments) ||
+                    !ReadFrames(reader, frames_count, segment.frames)) {
+                return false;
+            }
+
+            for (auto frame : segment.frames) {
+                shared_frames[frame] = key;
+            }
+            segments[key] = segment;
+        }
+
+        unsigned long long mailboxes_count;
+        if (!reader.Read(mailboxes_count)) {
+            return false;
+        }
+        for (unsigned long long i = 0; i < mailboxes_count; ++i) {
+            key_type key;
+            unsigned long long messages_count, receivers_count;
+            if (!reader.Read(key) || !reader.Read(messages_count)) {
+                return false;
+            }
+
+            Mailbox &mailbox = mailboxes[key];
+            for (unsigned long long j = 0; j < messages_count; ++j) {
+                Memory::ram_size_type message;
+                if (!reader.Read(message)) {
+                    return false;
+                }
+                mailbox.messages.push_back(message);
+            }
+
+            if (!reader.Read(receivers_count)) {
+                return false;
+            }
+            for (unsigned long long j = 0; j < receivers_count; ++j) {
+                Process::process_id_type receiver;
+                if (!reader.Read(receiver)) {
+                    return false;
+                }
+                mailbox.receivers.push_back(receiver);
+            }
+        }
+
+        return true;
+    }
+
+    void IPC::WriteFrames(
+                  Checkpoint::Writer &writer,
+                  const frames_type &frames
+              )
+    {
+        writer.Write(static_cast<unsigned long long>(frames.size()));
+        for (auto frame : frames) {
+            writer.Write(frame);
+        }
+    }
+
+    bool IPC::ReadFrames(
+                  Checkpoint::Reader &reader,
+                  Memory::page_table_size_type frames_count,
+                  frames_type &frames
+              )
+    {
+        unsigned long long segment_frames_count;
+        if (!reader.Read(segment_frames_count) ||
+                segment_frames_count > frames_count) {
+            return false;
+        }
+
+        frames.resize(segment_frames_count);
+        for (auto &frame : frames) {
+            if (!reader.Read(frame) || frame >= frames_count) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
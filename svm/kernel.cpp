@@ -1,184 +1,456 @@
 #include "kernel.h"
+#include "verifier.h"
 
 #include <iostream>
 #include <algorithm>
+#include <utility>
 
 namespace svm
 {
+    volatile std::sig_atomic_t Kernel::_interrupted = 0;
+
+    Kernel::Options::Options()
+        : disk_image_path(),
+          checkpoint_path(),
+          checkpoint_interval(DEFAULT_CHECKPOINT_INTERVAL),
+          restore_path(),
+          record_path(),
+          replay_path(),
+          profile_path(),
+          profile_interval(Profiler::DEFAULT_INTERVAL),
+          profile_stack_depth(0),
+          verify(true),
+          trace_path(),
+          trace_level(Trace::Info),
+          input_path(),
+          mapped_file_paths(),
+          cache() { }
+
+    Kernel::Statistics::Statistics()
+        : page_faults(0),
+          compacted_blocks(0),
+          compacted_words(0),
+          swapped_out_pages(0),
+          swapped_in_pages(0),
+          suspensions(0),
+          realtime_jobs(0),
+          deadline_misses(0) { }
+
     Kernel::Kernel(
                 Scheduler scheduler,
-                std::vector<Memory::ram_type> executables_paths
+                std::vector<Memory::ram_type> executables_paths,
+                const Options &options
             )
         : board(),
           processes(),
-          priorities(),
+          blocked(),
+          suspended(),
+          realtime(),
           scheduler(scheduler),
+          page_table(Memory::INVALID_PAGE),
+          last_events(NoEvents),
+          last_event_process_id(0),
           _last_issued_process_id(0),
           _last_ram_position(0),
           _cycles_passed_after_preemption(0),
-          _current_process_index(0)
+          _current_process_index(0),
+          _stop_events(NoEvents),
+          _stopped(false),
+          _shut_down(false),
+          _profile_path(options.profile_path),
+          _checkpoint_path(),
+          _checkpoint_interval(0),
+          _checkpoint_cycle(0),
+          _checkpoint_writer(),
+          _event_log(),
+          _replayed_disk_completions(),
+          _replayed_admissions(),
+          _profiler(),
+          _verify(options.verify),
+          _syscalls(),
+          _message_cache(
+              board.memory,
+              IPC::MESSAGE_SIZE,
+              [this](Memory::ram_size_type units) {
+                  return AllocateMemory(units);
+              },
+              [this](Memory::ram_size_type address) {
+                  FreeMemory(address);
+              },
+              [this](Memory::ram_size_type message) {
+                  auto &ram = board.memory.ram;
+                  ram[message] = 0;
+                  std::fill(
+                      ram.begin() + message + 1,
+                      ram.begin() + message + IPC::MESSAGE_SIZE,
+                      static_cast<int>(Memory::INVALID_PAGE)
+                  );
+              }
+          ),
+          _page_table_cache(
+              board.memory,
+              Memory::PAGE_TABLE_SIZE,
+              [this](Memory::ram_size_type units) {
+                  return AllocateMemory(units);
+              },
+              [this](Memory::ram_size_type address) {
+                  FreeMemory(address);
+              },
+              [this](Memory::ram_size_type table) {
+                  board.memory.ClearPageTable(table);
+              }
+          ),
+          _pcb_cache(
+              board.memory,
+              Process::PCB_RECORD_SIZE,
+              [this](Memory::ram_size_type units) {
+                  return AllocateMemory(units);
+              },
+              [this](Memory::ram_size_type address) {
+                  FreeMemory(address);
+              },
+              [this](Memory::ram_size_type record) {
+                  auto &ram = board.memory.ram;
+                  std::fill(
+                      ram.begin() + record,
+                      ram.begin() + record + Process::PCB_RECORD_SIZE,
+                      0
+                  );
+              }
+          ),
+          _batch_result_address(Memory::INVALID_PAGE),
+          _page_faults(0),
+          _compacting(false),
+          _compaction_credit(0),
+          _compacted_words(0),
+          _compacted_blocks(0),
+          _input_readers(),
+          _timers(
+              board.memory,
+              [this](Memory::ram_size_type units) {
+                  return AllocateMemory(units);
+              },
+              [this](Memory::ram_size_type address) {
+                  FreeMemory(address);
+              }
+          ),
+          _expired_timers(),
+          _mappings(),
+          _swap(),
+          _arrivals(),
+          _frame_ages(Memory::DEFAULT_RAM_SIZE / Memory::PAGE_SIZE, 0),
+          _dispatch_cycle(0),
+          _dispatch_instructions(0),
+          _last_sample_cycle(0),
+          _last_control_cycle(0),
+          _control_faults(0),
+          _out_of_frames(false),
+          _swapped_out_pages(0),
+          _swapped_in_pages(0),
+          _suspensions(0),
+          _running_realtime(false),
+          _realtime_jobs(0),
+          _deadline_misses(0)
     {
+        if (!options.trace_path.empty() &&
+                !board.trace.Start(options.trace_path, options.trace_level)) {
+            std::cerr << "Kernel: failed to create the trace file."
+                      << std::endl;
+        }
 
         // Memory Management
 
         /*
          *     Initialize data structures for methods `AllocateMemory` and
-         *       `FreeMemory`
+         *       `FreeMemory`. The kernel page table maps all of RAM
+         *       linearly and never changes, so kernel addresses are
+         *       physical ones and the allocator indexes RAM directly
          */
+        board.memory.ReserveFrames(_KERNEL_MEMORY_SIZE / Memory::PAGE_SIZE);
+
 		_last_free_block_index = 0;
 		board.memory.ram[0] = 0;
-		board.memory.ram[1] = Memory::DEFAULT_RAM_SIZE - 2;
-		
+		board.memory.ram[1] = _KERNEL_MEMORY_SIZE - 2;
+
+        // Page tables live in the heap as well, the one of the kernel
+        //   comes first
+        page_table = _page_table_cache.Allocate();
+        board.memory.MapDirectly(page_table);
+        board.memory.page_table = page_table;
+
+
+        // Cache model, off unless L1 is configured
+        if (options.cache.IsEnabled()) {
+            board.cache.Configure(options.cache);
+            board.cpu.cache = &board.cache;
+        }
 
         // Process page faults (find empty frames)
-        board.pic.isr_4 = [&]() {	
+        board.pic.isr_4 = [&]() {
             TryPageFault();
         };
 
+        // Devices
+
+        if (!options.disk_image_path.empty() &&
+                !board.disk.Open(options.disk_image_path)) {
+            std::cerr << "Kernel: failed to open the disk image."
+                      << std::endl;
+        }
+
+        // Disk completion
+        board.pic.isr_2 = [&]() {
+            CompleteDiskRequests();
+        };
+
+        // System Calls (registered before any process is verified)
+
+        // Process exit, the same for all schedulers (each one picks the next
+        //   process in `RemoveCurrentProcess`)
+        _syscalls.Register(SyscallTable::EXIT, [&]() {
+            TerminateCurrentProcess();
+        }, false);
+
+        // Disk read and write: block in 'a', virtual address of the buffer
+        //   in 'b'
+        _syscalls.Register(SyscallTable::DISK_READ, [&]() {
+            SubmitDiskRequest(Disk::Read);
+        }, true);
+        _syscalls.Register(SyscallTable::DISK_WRITE, [&]() {
+            SubmitDiskRequest(Disk::Write);
+        }, true);
+
+        // Interprocess communication: key in 'a', page aligned virtual
+        //   address in 'b', number of pages in 'c'
+        _syscalls.Register(SyscallTable::SHARE, [&]() {
+            AttachSharedSegment();
+        }, true);
+        _syscalls.Register(SyscallTable::SEND, [&]() {
+            SendMessage();
+        }, false);
+        _syscalls.Register(SyscallTable::RECEIVE, [&]() {
+            ReceiveMessage();
+        }, false);
+
+        // Vectored calls: entries in 'a', number of entries in 'b'
+        _syscalls.Register(SyscallTable::BATCH, [&]() {
+            SubmitBatch();
+        }, false);
+
+        // Host input: virtual address of the buffer in 'a', maximum number
+        //   of words in 'b'
+        _syscalls.Register(SyscallTable::INPUT, [&]() {
+            ReadInput();
+        }, false);
+
+        // Timers: cycles in 'a'
+        _syscalls.Register(SyscallTable::SLEEP, [&]() {
+            Sleep();
+        }, false);
+        _syscalls.Register(SyscallTable::TIMEOUT, [&]() {
+            SetTimeout();
+        }, true);
+
+        // Mapped host files: file and first page of the file in 'a', page
+        //   aligned virtual address in 'b', number of pages in 'c'.
+        //   Unmapping takes the address of the region in 'a'
+        _syscalls.Register(SyscallTable::MMAP, [&]() {
+            MapFile();
+        }, true);
+        _syscalls.Register(SyscallTable::MUNMAP, [&]() {
+            UnmapFile();
+        }, true);
+
+        // Real-time class: period in 'a', deadline relative to the release
+        //   in 'b', budget in 'c' (cycles). Returns -1 when the parameters
+        //   are invalid or the CPU can not take them. `next_period` ends
+        //   the current job
+        _syscalls.Register(SyscallTable::REALTIME, [&]() {
+            SetRealtime();
+        }, false);
+        _syscalls.Register(SyscallTable::NEXT_PERIOD, [&]() {
+            WaitForNextPeriod();
+        }, false);
+
+        // Performance counters: buffer of four words in 'a'
+        _syscalls.Register(SyscallTable::COUNTERS, [&]() {
+            ReadCounters();
+        }, true);
+
+        board.pic.syscall = [&](int number) {
+            if (processes.empty() && realtime.empty()) {
+                return;
+            }
+
+            SVM_TRACE(
+                board.trace, Trace::Debug,
+                Trace::Syscall, CurrentProcess().id,
+                number, board.cpu.registers.a
+            );
+
+            StopAtEvent(Syscall, CurrentProcess().id);
+
+            // Unverified processes may use any number
+            if (!_syscalls.Dispatch(number)) {
+                board.cpu.registers.a = -1;
+            }
+        };
+
+        // Jump over idle time straight to the next event instead of ticking
+        //   every cycle while nothing is runnable
+        board.idle = [&]() {
+            return CyclesUntilNextEvent();
+        };
+
+        // Record/replay of the nondeterministic inputs
+
+        if (!options.record_path.empty() &&
+                !_event_log.OpenForRecording(options.record_path)) {
+            std::cerr << "Kernel: failed to create the event log."
+                      << std::endl;
+        }
+        if (!options.replay_path.empty()) {
+            if (_event_log.OpenForReplay(options.replay_path)) {
+                // Completions arrive at the recorded cycles, not when the
+                //   host happens to finish
+                board.disk.exact_completions = true;
+            } else {
+                std::cerr << "Kernel: failed to read the event log."
+                          << std::endl;
+            }
+        }
+
+        // Host input, a replay takes the recorded input instead
+        if (_event_log.IsReplaying()) {
+            EventLog::Event event;
+            while (_event_log.Next(EventLog::HostInput, event)) {
+                board.keyboard.Schedule(event.cycle, event.words);
+            }
+        } else if (!options.input_path.empty() &&
+                       !board.keyboard.Open(options.input_path)) {
+            std::cerr << "Kernel: failed to open the input."
+                      << std::endl;
+        }
+
+        board.pic.isr_1 = [&]() {
+            CompleteInputReads();
+        };
+
+        if (!_mappings.Open(options.mapped_file_paths)) {
+            std::cerr << "Kernel: failed to open a mapped file."
+                      << std::endl;
+        }
+
+        // Guest profiling on the second PIT channel, the channel stays off
+        //   otherwise
+
+        if (!options.profile_path.empty()) {
+            _profiler.Start(
+                Profiler::DEFAULT_CAPACITY,
+                options.profile_stack_depth
+            );
+
+            board.pit.sampling_frequency =
+                options.profile_interval > 0 ? options.profile_interval : 1;
+            board.pit.sample = [&]() {
+                SampleCurrentProcess();
+            };
+        }
+
         // Process Management
 
-        std::for_each(
-            executables_paths.begin(),
-            executables_paths.end(),
-            [&](Memory::ram_type &executable) {
-                CreateProcess(executable);
+        // No process is on the CPU until the first one is dispatched
+        board.cpu.halted = true;
+
+        if (!options.restore_path.empty()) {
+            // Continue a previous run, the checkpoint has the processes
+            //   and the CPU state
+            if (!RestoreCheckpoint(options.restore_path)) {
+                std::cerr << "Kernel: failed to restore the checkpoint."
+                          << std::endl;
+
+                // Nothing of the image was applied, there is nothing to run
+                StopMachine();
             }
-        );
+        } else {
+            if (_event_log.IsReplaying()) {
+                // The recorded images replace the ones given on the command
+                //   line. The ones a host loaded later come at their cycles
+                executables_paths.clear();
 
-        /*
-         *    Switch to the first process on the CPU
-         *    Switch the page table in the MMU to the table of the current
-         *      process
-         *    Set a proper state for the first process
-         */
-		if (scheduler == FirstComeFirstServed || scheduler == ShortestJob ||
-			scheduler == RoundRobin) {
-			if (!processes.empty()) {
-				_current_process_index = 0;
-				board.memory.page_table = 
-					processes[_current_process_index ].page_table;
-				board.cpu.registers = 
-					processes[_current_process_index ].registers;
-				processes[_current_process_index ].state = 
-					Process::States::Running;
-			} else
-				board.Stop();
-		} else if (scheduler == Priority) {
-			if (!priorities.empty()) {
-				//always pick first
-				Process t = priorities.top();
-				t.state = Process::States::Running;
-				board.memory.page_table = t.page_table;
-				board.cpu.registers = t.registers;
-				
-				priorities.pop();
-                priorities.push(t);
-			} else 
-				board.Stop();
-		}
-		
+                EventLog::Event event;
+                while (_event_log.Next(EventLog::Admission, event)) {
+                    if (event.cycle == board.cycles) {
+                        executables_paths.push_back(event.words);
+                    } else {
+                        _replayed_admissions.push_back(event);
+                    }
+                }
+            }
+
+            std::for_each(
+                executables_paths.begin(),
+                executables_paths.end(),
+                [&](Memory::ram_type &executable) {
+                    SubmitProcess(executable);
+                }
+            );
+
+            /*
+             *    Switch to the first process on the CPU
+             *    Switch the page table in the MMU to the table of the current
+             *      process
+             *    Set a proper state for the first process
+             */
+            if (!processes.empty()) {
+                _current_process_index = 0;
+                SwitchToCurrentProcess();
+            }
+        }
+
+        // Periodic checkpoints, SIGINT pauses the run at the next one
+        if (!options.checkpoint_path.empty()) {
+            _checkpoint_path = options.checkpoint_path;
+            _checkpoint_interval =
+                options.checkpoint_interval > 0 ?
+                    options.checkpoint_interval : 1;
+
+            std::signal(SIGINT, InterruptHandler);
+
+            _checkpoint_cycle = board.cycles + _checkpoint_interval;
+        }
+
+        // Checkpoints and the replayed admissions share the alarm
+        board.alarm = [&]() {
+            Alarm();
+        };
+        ArmAlarm();
 
         if (scheduler == FirstComeFirstServed) {
             board.pic.isr_0 = [&]() {
                 // Process the timer interrupt for the FCFS
             };
-
-            board.pic.isr_3 = [&]() {
-                // Process the first software interrupt for the FCFS
-
-                if (!processes.empty()) {
-						// Unload the current process
-						// release data in RAM
-						FreeMemory(processes[_current_process_index].memory_start_position);
-                        processes.erase(processes.begin());
-                        if (!processes.empty()) {
-                                //always pick first
-                                _current_process_index = 0;
-                                processes[_current_process_index].state = Process::States::Running;
-                                //schedular doesn't block process, just terminates it
-								//and as a result doesn't load it later, therefore
-                                //the following line is redundant
-                                //board.cpu.registers = processes[_current_process_index].registers;
-                        }
-                        else board.Stop();
-                }
-            };
         } else if (scheduler == ShortestJob) {
             board.pic.isr_0 = [&]() {
                 // Process the timer interrupt for the Shortest
                 //  Job First scheduler
             };
-
-            board.pic.isr_3 = [&]() {
-                // Process the first software interrupt for the Shortest
-                //  Job scheduler
-				if (!processes.empty()) {
-						// Unload the current process
-						// release data in RAM
-						FreeMemory(processes[_current_process_index].memory_start_position);
-                        processes.erase(processes.begin());
-                        if (!processes.empty()) {
-                                //always pick first
-                                _current_process_index = 0;
-                                processes[_current_process_index].state = Process::States::Running;
-                                //schedular doesn't block process, just terminates it
-								//and as a result doesn't load it later, therefore
-                                //the following line is redundant
-                                //board.cpu.registers = processes[_current_process_index].registers;
-                        }
-                        else board.Stop();
-                }
-                
-            };
         } else if (scheduler == RoundRobin) {
             board.pic.isr_0 = [&]() {
                 // Process the timer interrupt for the Round Robin
                 //  scheduler
 				++_cycles_passed_after_preemption;
                 if (_cycles_passed_after_preemption > _MAX_CYCLES_BEFORE_PREEMPTION) {
-						
-                        processes[_current_process_index ].registers = board.cpu.registers;
-                        processes[_current_process_index ].state = Process::States::Ready;
+                    if (!board.cpu.halted) {
+                        SaveCurrentProcess(Process::States::Ready);
                         if (_current_process_index < processes.size() - 1) {
-                                ++_current_process_index;
+                            ++_current_process_index;
                         }
                         else _current_process_index = 0;
-						board.memory.page_table = 
-							processes[_current_process_index ].page_table;
-                        board.cpu.registers = 
-							processes[_current_process_index ].registers;
-                        processes[_current_process_index ].state = 
-							Process::States::Running;
-
-                        _cycles_passed_after_preemption = 0;
-                }
-            };
+                        SwitchToCurrentProcess();
+                    }
 
-            board.pic.isr_3 = [&]() {
-                //Process the first software interrupt for the
-                //Round Robin scheduler
-
-                // Unload the current process
-				if (!processes.empty()) {
-                        //terminate current process
-						//release data in RAM
-						FreeMemory(processes[_current_process_index].memory_start_position);
-                        processes.erase(processes.begin() + _current_process_index);
-                        if (!processes.empty()) {
-                                if (_current_process_index < processes.size()) {
-                                        ++_current_process_index;
-                                }
-                                else _current_process_index = 0;
-                                //load next
-								//change address space
-								board.memory.page_table = 
-									processes[_current_process_index ].page_table;
-                                board.cpu.registers = 
-									processes[_current_process_index ].registers;
-                                processes[_current_process_index ].state = 
-									Process::States::Running;
-                        }
-                        else board.Stop();
+                    _cycles_passed_after_preemption = 0;
                 }
             };
         } else if (scheduler == Priority) {
@@ -187,235 +459,3158 @@ namespace svm
                 //  Priority scheduler
 				++_cycles_passed_after_preemption;
                 if (_cycles_passed_after_preemption > _MAX_CYCLES_BEFORE_PREEMPTION) {
-                        Process t = priorities.top();
-                        --t.priority;
-                        t.registers = board.cpu.registers;
-                        t.state = Process::States::Ready;
+                    if (!board.cpu.halted) {
+                        SaveCurrentProcess(Process::States::Ready);
 
-                        priorities.pop();
-                        priorities.push(t);
-
-                        t = priorities.top();
-						board.memory.page_table = t.page_table; 
-                        t.state = Process::States::Running;
-                        board.cpu.registers = t.registers;
+                        // Age the running process and let the heap pick
+                        //   the next one
+                        std::pop_heap(processes.begin(), processes.end());
+                        if (processes.back().priority > 0) {
+                            --processes.back().priority;
+                        }
+                        std::push_heap(processes.begin(), processes.end());
 
-                        priorities.pop();
-                        priorities.push(t);
+                        _current_process_index = 0;
+                        SwitchToCurrentProcess();
+                    }
 
-                        _cycles_passed_after_preemption = 0;
+                    _cycles_passed_after_preemption = 0;
                 }
             };
+        }
 
-            board.pic.isr_3 = [&]() {
-                // Process the first software interrupt for the Priority
-                //  Priority scheduler
-				if (!priorities.empty()) {
-						// Unload the current process
-						//release data in RAM
-						Process t = priorities.top();
-						FreeMemory(t.memory_start_position);
-                        priorities.pop();
-                        if (!priorities.empty()) {
-                                //always pick first
-                                Process t = priorities.top();
-                                t.state = Process::States::Running;
-								board.memory.page_table = t.page_table;
-                                board.cpu.registers = t.registers;
-
-                                priorities.pop();
-                                priorities.push(t);
-                        }
-                        else board.Stop();
+        // Timers expire and the load is controlled before the scheduler
+        //   picks the next process, heap compaction runs behind it. The
+        //   normal class is not scheduled while a real-time process runs
+        auto schedule = board.pic.isr_0;
+        board.pic.isr_0 = [&, schedule]() {
+            ExpireTimers();
+            SampleWorkingSets();
+            ControlLoad();
+            EnforceBudgets();
+            if (!_running_realtime) {
+                schedule();
+            }
+            CompactMemoryStep();
+        };
+    }
+
+    Kernel::~Kernel()
+    {
+        Shutdown();
+
+        if (_checkpoint_writer.joinable()) {
+            _checkpoint_writer.join();
+        }
+    }
+
+    void Kernel::Run()
+    {
+        if (!IsFinished()) {
+            Run(Board::NO_LIMIT);
+
+            PrintStatistics();
+        }
+
+        Shutdown();
+    }
+
+    Kernel::RunResults Kernel::Run(
+                                   Board::cycles_type cycles,
+                                   unsigned int events
+                               )
+    {
+        last_events = NoEvents;
+        last_event_process_id = 0;
+
+        if (IsFinished()) {
+            return Stopped;
+        }
+
+        Board::cycles_type limit = Board::NO_LIMIT;
+        if (cycles < limit - board.cycles) {
+            limit = board.cycles + cycles;
+        }
+
+        _stop_events = events;
+        bool stopped = board.Run(limit);
+        _stop_events = NoEvents;
+
+        if (!stopped) {
+            return CyclesElapsed;
+        }
+
+        // An event stops the run before the kernel does in the same cycle,
+        //   the next call reports the end
+        return last_events != NoEvents ? EventOccurred : Stopped;
+    }
+
+    bool Kernel::IsFinished() const
+    {
+        return _stopped ||
+                   (processes.empty() && blocked.empty() && realtime.empty() &&
+                        _replayed_admissions.empty());
+    }
+
+    void Kernel::Shutdown()
+    {
+        if (_shut_down) {
+            return;
+        }
+        _shut_down = true;
+
+        if (_profiler.IsEnabled() && !_profiler.Save(_profile_path)) {
+            std::cerr << "Kernel: failed to write the profile." << std::endl;
+        }
+
+        board.trace.Stop();
+
+        if (_event_log.IsRecording()) {
+            _event_log.Close(board.cycles);
+        } else if (_event_log.IsReplaying()) {
+            EventLog::Event event;
+            if (_event_log.Next(EventLog::End, event) &&
+                    event.cycle == board.cycles) {
+                std::cout << "Kernel: the replay matched the recording."
+                          << std::endl;
+            } else {
+                std::cout << "Kernel: the replay diverged from the recording."
+                          << std::endl;
+            }
+        }
+    }
+
+    void Kernel::SubmitProcess(Memory::ram_type &executable)
+    {
+        if (_event_log.IsRecording()) {
+            EventLog::Event event;
+            event.type = EventLog::Admission;
+            event.cycle = board.cycles;
+            event.words = executable;
+
+            _event_log.Record(event);
+        }
+
+        Executable program;
+        if (!program.Parse(executable)) {
+            std::cerr << "Kernel: invalid executable header."
+                      << std::endl;
+
+            return;
+        }
+
+        // The first process is always admitted, the others wait in order
+        //   until their allotment is free
+        if (_arrivals.empty() &&
+                ((processes.empty() && blocked.empty() && realtime.empty()) ||
+                     CountUnreservedFrames() >=
+                         static_cast<long long>(GetInitialAllotment(program)))) {
+            CreateProcess(executable, program);
+        } else {
+            Arrival arrival = { executable, program };
+            _arrivals.push_back(arrival);
+        }
+    }
+
+    void Kernel::Alarm()
+    {
+        // Images the host loaded while the recording ran
+        while (!_replayed_admissions.empty() &&
+                   _replayed_admissions.front().cycle <= board.cycles) {
+            Load(_replayed_admissions.front().words);
+            _replayed_admissions.pop_front();
+        }
+
+        if (!_checkpoint_path.empty() && board.cycles >= _checkpoint_cycle) {
+            // Requests in flight live on the host I/O thread and can not
+            //   be saved, wait until the disk is quiet
+            if (board.disk.HasOutstandingRequests()) {
+                _checkpoint_cycle = board.cycles + 1;
+            } else {
+                SaveCheckpoint();
+
+                if (_interrupted) {
+                    std::cerr << "Kernel: paused, the state is saved to "
+                              << _checkpoint_path << "." << std::endl;
+                    StopMachine();
                 }
-                
-            };
+
+                _checkpoint_cycle = board.cycles + _checkpoint_interval;
+            }
+        }
+
+        ArmAlarm();
+    }
+
+    void Kernel::ArmAlarm()
+    {
+        board.alarm_cycle = Board::NO_LIMIT;
+        if (!_checkpoint_path.empty()) {
+            board.alarm_cycle = _checkpoint_cycle;
         }
+        if (!_replayed_admissions.empty() &&
+                _replayed_admissions.front().cycle < board.alarm_cycle) {
+            board.alarm_cycle = _replayed_admissions.front().cycle;
+        }
+    }
 
-        board.Start();
+    void Kernel::Load(const Memory::ram_type &executable)
+    {
+        Memory::ram_type image = executable;
+
+        bool was_idle = board.cpu.halted;
+        SubmitProcess(image);
+        if (was_idle && !processes.empty()) {
+            _current_process_index = 0;
+            SwitchToCurrentProcess();
+        }
     }
 
-    Kernel::~Kernel() { }
+    Memory::page_table_size_type Kernel::GetInitialAllotment(
+                                             const Executable &program
+                                         )
+    {
+        if (program.working_set > _MIN_ALLOTMENT) {
+            return program.working_set;
+        }
+
+        return _MIN_ALLOTMENT;
+    }
 
-    void Kernel::CreateProcess(Memory::ram_type &executable)
+    void Kernel::CreateProcess(
+                     const Memory::ram_type &executable,
+                     const Executable &program
+                 )
     {
+        const Executable::Segment *text = program.Find(Executable::Text);
+
 		// Allocate memory for the process with `AllocateMemory`
         Memory::ram_size_type
-            new_memory_position = AllocateMemory(executable.size());
-        
+            new_memory_position = AllocateMemory(text->memory_size);
+
         if (new_memory_position == NO_FREE_LARGE_ENOUGH_BLOCK) {
             std::cerr << "Kernel: failed to allocate memory."
                       << std::endl;
         } else {
-            // Assume that the executable image size can not be greater than
-            //   a page size
-            std::copy(
-                executable.begin(),
-                executable.end(),
-                board.memory.ram.begin() + new_memory_position);
+            // The kernel heap is identity mapped, so the text is
+            //   contiguous in physical memory
+            auto text_begin = executable.begin() + text->offset;
+            auto position = board.memory.ram.begin() + new_memory_position;
+            std::copy(text_begin, text_begin + text->file_size, position);
+            std::fill(
+                position + text->file_size,
+                position + text->memory_size,
+                0
+            );
 
             Process process(
                 _last_issued_process_id++,
                 new_memory_position,
-                new_memory_position + executable.size()
+                new_memory_position + text->memory_size
             );
+            process.page_table = _page_table_cache.Allocate();
+            if (process.page_table == SlabCache::NO_OBJECT) {
+                std::cerr << "Kernel: failed to allocate memory."
+                          << std::endl;
+
+                FreeMemory(new_memory_position);
+
+                return;
+            }
+            process.pcb = _pcb_cache.Allocate();
+            if (process.pcb == SlabCache::NO_OBJECT) {
+                std::cerr << "Kernel: failed to allocate memory."
+                          << std::endl;
+
+                _page_table_cache.Free(process.page_table);
+                FreeMemory(new_memory_position);
+
+                return;
+            }
+
+            // Hints of the image replace the guesses made from its size
+            Registers registers;
+            registers.ip = new_memory_position + program.entry;
+            process.StoreRegisters(board.memory, registers);
+            process.priority = program.priority;
+            process.sequential_instruction_count = program.expected_burst;
+            process.allotment = GetInitialAllotment(program);
+
+            Verifier::Result verification;
+            if (_verify) {
+                verification =
+                    Verifier::Verify(
+                        &board.memory.ram[new_memory_position],
+                        text->memory_size,
+                        Memory::PAGE_TABLE_SIZE,
+                        _syscalls
+                    );
+                process.verified = verification.verified;
+            }
+
+            if (!MapSegments(process, program, executable, verification.pages)) {
+                std::cerr << "Kernel: failed to map the executable segments."
+                          << std::endl;
+
+                ReleaseProcessMemory(process);
+
+                return;
+            }
+
+            if (_profiler.IsEnabled()) {
+                _profiler.AddImage(
+                    process.id,
+                    Memory::ram_type(text_begin, text_begin + text->file_size)
+                );
+            }
 
             // add the new process to an appropriate data structure
-			if (scheduler == FirstComeFirstServed || scheduler == RoundRobin) {
-                processes.push_back(process);
-			} else if (scheduler == ShortestJob) {
-					processes.push_back(process);
-					sort(processes.begin(), processes.end(), 
-							[](const Process& p1, const Process& p2) {
-							return p1.sequential_instruction_count < 
-								p2.sequential_instruction_count;});
-			}
-			else if (scheduler == Priority) {
-					priorities.push(process);
-			}
+            EnqueueProcess(process);
         }
     }
 
-    Memory::ram_size_type Kernel::AllocateMemory(
-                                      Memory::ram_size_type units
-                                  )
-    {		
-		 
-		units += 2; // 2 additional cells for a header
-        
-        Memory::ram_size_type current_free_node_index, previous_free_node_index;
-        
-		auto &ram = board.memory.ram;
-		
-		
-        previous_free_node_index = _last_free_block_index;
-        for (current_free_node_index = ram[Translate(previous_free_node_index)]; ;
-             previous_free_node_index = current_free_node_index,
-             current_free_node_index = ram[Translate(current_free_node_index)]) {
-            if (ram[Translate(current_free_node_index + 1)] >= units) {
-                if (ram[Translate(current_free_node_index + 1)] == units) {
-                    ram[Translate(previous_free_node_index)] =
-                        ram[Translate(current_free_node_index)];
-                    _last_free_block_index = ram[Translate(current_free_node_index)];
-                } else {
-                    ram[Translate(current_free_node_index + 1)] -= units;
-                    _last_free_block_index = current_free_node_index;
-                    current_free_node_index += 
-						ram[Translate(current_free_node_index + 1)] + 2;
-                    ram[Translate(current_free_node_index + 1)] = units - 2;
+    bool Kernel::MapSegments(
+                     Process &process,
+                     const Executable &program,
+                     const Memory::ram_type &image,
+                     const std::vector<Memory::page_table_size_type> &static_pages
+                 )
+    {
+        auto &ram = board.memory.ram;
+
+        // Data is copied a page at a time, a segment does not have to start
+        //   on a page boundary
+        const Executable::Segment *data = program.Find(Executable::Data);
+        if (data) {
+            Memory::ram_size_type copied = 0;
+            while (copied < data->file_size) {
+                Memory::vmem_size_type virtual_address = data->address + copied;
+                Memory::ram_size_type physical_address =
+                    TranslateProcessAddress(process, virtual_address);
+                if (physical_address == Memory::INVALID_PAGE) {
+                    return false;
                 }
-				
-				//return physical address
-                return Translate(current_free_node_index + 2);
+
+                Memory::ram_size_type count =
+                    std::min(
+                        Memory::PAGE_SIZE - virtual_address % Memory::PAGE_SIZE,
+                        data->file_size - copied
+                    );
+                auto source = image.begin() + data->offset + copied;
+                std::copy(source, source + count, ram.begin() + physical_address);
+
+                copied += count;
             }
-            if (current_free_node_index == _last_free_block_index) {
-                return NO_FREE_LARGE_ENOUGH_BLOCK;
+        }
+
+        // Frames come zeroed, so bss only needs mappings. The working set
+        //   hint says how many pages to map now instead of on faults, as
+        //   long as free frames are left
+        Memory::ram_size_type mapped_pages =
+            board.memory.CountMappedPages(process.page_table);
+
+        // Bss pages first, then the pages the verifier found in `ld`/`st`
+        std::vector<Memory::page_table_size_type> pages;
+        const Executable::Segment *bss = program.Find(Executable::Bss);
+        if (bss && bss->memory_size > 0) {
+            Memory::page_table_size_type last_page =
+                (bss->address + bss->memory_size - 1) / Memory::PAGE_SIZE;
+            for (Memory::page_table_size_type page =
+                     bss->address / Memory::PAGE_SIZE;
+                     page <= last_page && pages.size() < program.working_set;
+                     ++page) {
+                pages.push_back(page);
             }
         }
+        pages.insert(pages.end(), static_pages.begin(), static_pages.end());
 
-        return NO_FREE_LARGE_ENOUGH_BLOCK;
+        for (auto page : pages) {
+            if (mapped_pages >= program.working_set ||
+                    board.memory.GetFreeFramesCount() == 0) {
+                break;
+            }
+            if (page < Memory::PAGE_TABLE_SIZE &&
+                    board.memory.GetPageEntry(process.page_table, page) ==
+                        Memory::INVALID_PAGE) {
+                board.memory.SetPageEntry(
+                    process.page_table,
+                    page,
+                    AcquireZeroedFrame()
+                );
+                ++mapped_pages;
+            }
+        }
+
+        return true;
     }
 
-    void Kernel::FreeMemory(
-                     Memory::ram_size_type physical_address
-                 )
+    void Kernel::ReleaseProcessMemory(Process &process)
     {
-        Memory::ram_size_type index_of_used_block_header = physical_address - 2;
-        Memory::ram_size_type index_of_size_of_used_block = physical_address - 1;
-		
-		auto &ram = board.memory.ram;
-        
-        Memory::ram_size_type current_index_of_free_node;
-        for (current_index_of_free_node = _last_free_block_index;
-                !(index_of_used_block_header > current_index_of_free_node &&
-                index_of_used_block_header < ram[Translate(current_index_of_free_node)]);
-                current_index_of_free_node = ram[Translate(current_index_of_free_node)]) {
-            if (current_index_of_free_node >= ram[Translate(current_index_of_free_node)] &&
-                (index_of_used_block_header > current_index_of_free_node ||
-                 index_of_used_block_header < ram[Translate(current_index_of_free_node)])) {
-                    break;
-                }
+        FreeMemory(process.memory_start_position);
+        _swap.Discard(process.id);
+
+        // Changes to mapped files are kept
+        for (;;) {
+            auto mapping =
+                std::find_if(
+                    _mappings.mappings.begin(),
+                    _mappings.mappings.end(),
+                    [&](const FileMappings::Mapping &process_mapping) {
+                        return process_mapping.process_id == process.id;
+                    }
+                );
+            if (mapping == _mappings.mappings.end()) {
+                break;
+            }
+            UnmapRegion(process, mapping);
         }
-        
-		//try to merge with the right block
-        if (index_of_used_block_header + ram[Translate(index_of_size_of_used_block)] == 
-			ram[Translate(current_index_of_free_node)]) {
-            ram[Translate(index_of_size_of_used_block)] += 
-				ram[Translate(ram[Translate(current_index_of_free_node)] + 1)] + 2;
-            ram[Translate(index_of_used_block_header)] = 
-				ram[Translate(ram[Translate(current_index_of_free_node)])];
-        } else {
-            ram[Translate(index_of_used_block_header)] = 
-				ram[Translate(current_index_of_free_node)];
+
+        // Frames of shared segments stay until the last process detaches
+        std::vector<IPC::key_type> segments;
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            Memory::page_entry_type frame =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (frame == Memory::INVALID_PAGE) {
+                continue;
+            }
+
+            auto shared_frame = _ipc.shared_frames.find(frame);
+            if (shared_frame == _ipc.shared_frames.end()) {
+                board.memory.ReleaseFrame(frame);
+            } else if (std::find(
+                           segments.begin(),
+                           segments.end(),
+                           shared_frame->second
+                       ) == segments.end()) {
+                segments.push_back(shared_frame->second);
+            }
         }
-        
-        //try to merge with the left block
-        if (current_index_of_free_node + 
-			ram[Translate(current_index_of_free_node + 1)] + 2 == index_of_used_block_header) {
-            ram[Translate(current_index_of_free_node + 1)] += 
-				ram[Translate(index_of_size_of_used_block)] + 2;
-            ram[Translate(current_index_of_free_node)] = 
-				ram[Translate(index_of_used_block_header)];
-        } else {
-            ram[Translate(current_index_of_free_node)] = index_of_used_block_header;
+        for (auto key : segments) {
+            IPC::Segment &segment = _ipc.segments[key];
+            if (--segment.attachments == 0) {
+                for (auto frame : segment.frames) {
+                    _ipc.shared_frames.erase(frame);
+                    board.memory.ReleaseFrame(frame);
+                }
+                _ipc.segments.erase(key);
+            }
         }
-        
-        _last_free_block_index = current_index_of_free_node;
+
+        // The caches take tables back empty and records cleared
+        board.memory.ClearPageTable(process.page_table);
+        _page_table_cache.Free(process.page_table);
+        process.page_table = Memory::INVALID_PAGE;
+        process.StoreRegisters(board.memory, Registers());
+        _pcb_cache.Free(process.pcb);
+        process.pcb = Memory::INVALID_PAGE;
     }
-	
-	//translate from virtual to physical address
-	Memory::ram_size_type Kernel::Translate(Memory::ram_size_type virtual_address) {
-        // 1. Get a page index and physical address offset from the MMU
-        // for a virtual address in 'data'
-        Memory::page_index_offset_pair_type page_index_offset_pair = 
-			board.memory.GetPageIndexAndOffsetForVirtualAddress(virtual_address);
+
+    Memory::page_entry_type Kernel::AcquireZeroedFrame()
+    {
+        Memory::page_entry_type frame = board.memory.AcquireFrame();
+        if (frame != Memory::INVALID_PAGE) {
+            // No data of a previous owner leaks, and bss reads as zero
+            auto frame_begin =
+                board.memory.ram.begin() + frame * Memory::PAGE_SIZE;
+            std::fill(frame_begin, frame_begin + Memory::PAGE_SIZE, 0);
+        }
+
+        return frame;
+    }
+
+    Memory::page_entry_type Kernel::AcquireProcessFrame(
+                                        const Process &process,
+                                        Memory::page_table_size_type page
+                                    )
+    {
+        // Other processes give up a page when no frame is free
+        Memory::page_entry_type frame = AcquireZeroedFrame();
+        if (frame == Memory::INVALID_PAGE && ReclaimFrame(process)) {
+            frame = AcquireZeroedFrame();
+        }
+        if (frame == Memory::INVALID_PAGE) {
+            return frame;
+        }
+        _frame_ages[frame] = 0;
+        board.memory.referenced[frame] = 0;
+
+        int *words = &board.memory.ram[frame * Memory::PAGE_SIZE];
+        const FileMappings::Mapping *mapping = _mappings.Find(process.id, page);
+        if (mapping) {
+            if (!_mappings.ReadPage(*mapping, page, words)) {
+                // The page stays zeroed
+                std::cerr << "Kernel: failed to read a mapped file."
+                          << std::endl;
+            }
+        } else if (_swap.Load(process.id, page, words)) {
+            ++_swapped_in_pages;
+        }
+
+        return frame;
+    }
+
+    Memory::page_table_size_type Kernel::CountResidentPages(
+                                             const Process &process
+                                         )
+    {
+        Memory::page_table_size_type resident_pages = 0;
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            Memory::page_entry_type frame =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (frame != Memory::INVALID_PAGE &&
+                    _ipc.shared_frames.count(frame) == 0) {
+                ++resident_pages;
+            }
+        }
+
+        return resident_pages;
+    }
+
+    Memory::page_table_size_type Kernel::CountWorkingSet(
+                                             const Process &process
+                                         )
+    {
+        Memory::page_table_size_type working_set = 0;
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            Memory::page_entry_type frame =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (frame != Memory::INVALID_PAGE &&
+                    _ipc.shared_frames.count(frame) == 0 &&
+                    GetFrameAge(frame) < _WORKING_SET_WINDOW) {
+                ++working_set;
+            }
+        }
+
+        return working_set;
+    }
+
+    unsigned int Kernel::GetFrameAge(Memory::page_entry_type frame)
+    {
+        return board.memory.referenced[frame] ? 0 : _frame_ages[frame];
+    }
+
+    long long Kernel::CountUnreservedFrames()
+    {
+        // Frames promised to the processes that they do not hold yet
+        long long unreserved_frames = board.memory.GetFreeFramesCount();
+        for (auto process_list : { &processes, &blocked, &realtime }) {
+            for (auto &process : *process_list) {
+                Memory::page_table_size_type resident_pages =
+                    CountResidentPages(process);
+                if (process.allotment > resident_pages) {
+                    unreserved_frames -= process.allotment - resident_pages;
+                }
+            }
+        }
+
+        return unreserved_frames;
+    }
+
+    void Kernel::UpdateAllotment(Process &process)
+    {
+        Board::cycles_type now =
+            process.run_cycles + (board.cycles - _dispatch_cycle);
+        bool frequent = now - process.fault_time < _PFF_FAULT_GAP;
+        process.fault_time = now;
+
+        if (frequent) {
+            if (process.allotment < Memory::PAGE_TABLE_SIZE) {
+                ++process.allotment;
+            }
+            return;
+        }
+
+        // Pages that were not used within the window go
+        Memory::page_table_size_type working_set = 0;
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            Memory::page_entry_type frame =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (frame == Memory::INVALID_PAGE ||
+                    _ipc.shared_frames.count(frame) > 0) {
+                continue;
+            }
+
+            if (GetFrameAge(frame) < _WORKING_SET_WINDOW) {
+                ++working_set;
+            } else {
+                EvictPage(process, page);
+            }
+        }
+        process.allotment =
+            working_set > _MIN_ALLOTMENT ? working_set : _MIN_ALLOTMENT;
+    }
+
+    void Kernel::EvictPage(Process &process, Memory::page_table_size_type page)
+    {
+        Memory::page_entry_type frame =
+            board.memory.GetPageEntry(process.page_table, page);
+        const int *words = &board.memory.ram[frame * Memory::PAGE_SIZE];
+
+        // Pages of mapped files go back to the file, the rest to the swap
+        //   space
+        const FileMappings::Mapping *mapping = _mappings.Find(process.id, page);
+        if (mapping) {
+            if (!_mappings.WritePage(*mapping, page, words)) {
+                std::cerr << "Kernel: failed to write a mapped file back."
+                          << std::endl;
+            }
+        } else {
+            _swap.Store(process.id, page, words);
+        }
+        ++_swapped_out_pages;
+
+        board.memory.ReleaseFrame(frame);
+        board.memory.SetPageEntry(
+            process.page_table,
+            page,
+            static_cast<Memory::page_entry_type>(Memory::INVALID_PAGE)
+        );
+    }
+
+    bool Kernel::EvictOldestPage(Process &process)
+    {
+        bool found = false;
+        Memory::page_table_size_type oldest_page = 0;
+        unsigned int oldest_age = 0;
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            Memory::page_entry_type frame =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (frame == Memory::INVALID_PAGE ||
+                    _ipc.shared_frames.count(frame) > 0) {
+                continue;
+            }
+
+            unsigned int age = GetFrameAge(frame);
+            if (!found || age > oldest_age) {
+                found = true;
+                oldest_page = page;
+                oldest_age = age;
+            }
+        }
+
+        if (found) {
+            EvictPage(process, oldest_page);
+        }
+
+        return found;
+    }
+
+    bool Kernel::ReclaimFrame(const Process &requester)
+    {
+        // The oldest page of the ready processes, the ones above their
+        //   allotment first. Blocked processes wait for devices that may
+        //   write into their frames
+        Process *victim = NULL;
+        Memory::page_table_size_type victim_page = 0;
+        unsigned int victim_score = 0;
+        for (auto &process : processes) {
+            if (process.id == requester.id || process.pending_requests > 0) {
+                continue;
+            }
+
+            bool over_allotment = CountResidentPages(process) > process.allotment;
+            for (Memory::page_table_size_type page = 0;
+                     page < Memory::PAGE_TABLE_SIZE; ++page) {
+                Memory::page_entry_type frame =
+                    board.memory.GetPageEntry(process.page_table, page);
+                if (frame == Memory::INVALID_PAGE ||
+                        _ipc.shared_frames.count(frame) > 0) {
+                    continue;
+                }
+
+                unsigned int score =
+                    (over_allotment ? 0x100 : 0) + GetFrameAge(frame) + 1;
+                if (score > victim_score) {
+                    victim = &process;
+                    victim_page = page;
+                    victim_score = score;
+                }
+            }
+        }
+
+        if (victim) {
+            EvictPage(*victim, victim_page);
+        }
+
+        return victim != NULL;
+    }
+
+    void Kernel::SampleWorkingSets()
+    {
+        if (board.cycles - _last_sample_cycle < _WORKING_SET_SAMPLE_INTERVAL) {
+            return;
+        }
+        _last_sample_cycle = board.cycles;
+
+        auto &referenced = board.memory.referenced;
+        for (Memory::page_entry_type frame =
+                 _KERNEL_MEMORY_SIZE / Memory::PAGE_SIZE;
+                 frame < referenced.size(); ++frame) {
+            if (referenced[frame]) {
+                referenced[frame] = 0;
+                _frame_ages[frame] = 0;
+            } else if (_frame_ages[frame] < 0xFF) {
+                ++_frame_ages[frame];
+            }
+        }
+    }
+
+    void Kernel::ControlLoad()
+    {
+        // A fault found no frame at all, the process waits outside until
+        //   the others give theirs back
+        if (_out_of_frames) {
+            _out_of_frames = false;
+            if (!board.cpu.halted && !_running_realtime) {
+                SuspendProcess(_current_process_index);
+            } else if (_running_realtime && !processes.empty()) {
+                // A real-time process takes the frames of the normal class
+                SuspendProcess(FindSuspensionVictim());
+            }
+        }
+
+        if (board.cycles - _last_control_cycle < _LOAD_CONTROL_INTERVAL) {
+            return;
+        }
+        _last_control_cycle = board.cycles;
+
+        unsigned long long faults = _page_faults - _control_faults;
+        _control_faults = _page_faults;
+
+        // Thrashing: faults are frequent and the allotments do not fit into
+        //   the frames. The process with the lowest priority, the newest of
+        //   them, leaves until the load goes down
+        if (faults >= _THRASHING_FAULTS) {
+            if (!processes.empty() &&
+                    processes.size() + blocked.size() + realtime.size() > 1 &&
+                    CountUnreservedFrames() < 0) {
+                SuspendProcess(FindSuspensionVictim());
+            }
+
+            return;
+        }
+
+        bool was_idle = board.cpu.halted;
+        if (AdmitProcesses(false) && was_idle) {
+            _current_process_index = 0;
+            SwitchToCurrentProcess();
+        }
+    }
+
+    Kernel::process_list_type::size_type Kernel::FindSuspensionVictim()
+    {
+        process_list_type::size_type victim = 0;
+        for (process_list_type::size_type i = 1; i < processes.size(); ++i) {
+            if (processes[i].priority < processes[victim].priority ||
+                    (processes[i].priority == processes[victim].priority &&
+                         processes[i].id > processes[victim].id)) {
+                victim = i;
+            }
+        }
+
+        return victim;
+    }
+
+    void Kernel::SuspendProcess(process_list_type::size_type index)
+    {
+        bool current =
+            !board.cpu.halted && !_running_realtime &&
+            index == _current_process_index;
+        if (current) {
+            SaveCurrentProcess(Process::States::Suspended);
+        }
+
+        Process &process = processes[index];
+        process.state = Process::States::Suspended;
+
+        // It comes back with the frames it was using
+        Memory::page_table_size_type working_set = CountWorkingSet(process);
+        process.allotment =
+            working_set > _MIN_ALLOTMENT ? working_set : _MIN_ALLOTMENT;
+
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            Memory::page_entry_type frame =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (frame != Memory::INVALID_PAGE &&
+                    _ipc.shared_frames.count(frame) == 0) {
+                EvictPage(process, page);
+            }
+        }
+
+        suspended.push_back(process);
+        ++_suspensions;
+
+        if (current) {
+            RemoveCurrentProcess();
+        } else {
+            if (scheduler == Priority) {
+                // Rebuilding the heap may put another one of the same
+                //   priority on top
+                bool was_running = !board.cpu.halted && !_running_realtime;
+                if (was_running) {
+                    SaveCurrentProcess(Process::States::Ready);
+                }
+
+                processes.erase(processes.begin() + index);
+                std::make_heap(processes.begin(), processes.end());
+
+                if (was_running) {
+                    _current_process_index = 0;
+                    SwitchToCurrentProcess();
+                }
+            } else {
+                processes.erase(processes.begin() + index);
+            }
+            if (scheduler != Priority && index < _current_process_index) {
+                --_current_process_index;
+            }
+        }
+    }
+
+    bool Kernel::AdmitProcesses(bool force)
+    {
+        bool admitted = false;
+
+        // Suspended processes come back before new ones are admitted
+        while (!suspended.empty()) {
+            if (!force &&
+                    CountUnreservedFrames() <
+                        static_cast<long long>(suspended.front().allotment)) {
+                return admitted;
+            }
+
+            Process resumed_process = suspended.front();
+            suspended.pop_front();
+            EnqueueProcess(resumed_process);
+
+            admitted = true;
+            force = false;
+        }
+
+        while (!_arrivals.empty()) {
+            if (!force &&
+                    CountUnreservedFrames() <
+                        static_cast<long long>(
+                            GetInitialAllotment(_arrivals.front().program)
+                        )) {
+                return admitted;
+            }
+
+            Arrival arrival = _arrivals.front();
+            _arrivals.pop_front();
+
+            process_list_type::size_type processes_count = processes.size();
+            CreateProcess(arrival.image, arrival.program);
+            if (processes.size() > processes_count) {
+                admitted = true;
+                force = false;
+            }
+        }
+
+        return admitted;
+    }
+
+    Memory::ram_size_type Kernel::AllocateMemory(
+                                      Memory::ram_size_type units
+                                  )
+    {		
+		 
+		units += 2; // 2 additional cells for a header
+        
+        Memory::ram_size_type current_free_node_index, previous_free_node_index;
+        
+		auto &ram = board.memory.ram;
 		
-        // 2. Get the page from the current page table in the MMU with
-        // the acquired index
-        Memory::page_entry_type page_frame_index = 
-			board.memory.page_table->at(page_index_offset_pair.first);
-        Memory::ram_size_type physical_index;
 		
-        if (page_frame_index == Memory::INVALID_PAGE) {
-			//save index in register 'a'
-			auto previous_a = board.cpu.registers.a;
-			board.cpu.registers.a = page_index_offset_pair.first;
-			
-            if (TryPageFault()) { //if there is a free physical memory calcuate index 
-				// Calculate the physical address with the value in the page entry and the
-				// physical address offset
-				physical_index = page_index_offset_pair.second + 
-									Memory::PAGE_SIZE * page_frame_index;
-			}
-			
-			//restore register 'a'
-			board.cpu.registers.a = previous_a;
+        previous_free_node_index = _last_free_block_index;
+        for (current_free_node_index = ram[previous_free_node_index]; ;
+             previous_free_node_index = current_free_node_index,
+             current_free_node_index = ram[current_free_node_index]) {
+            if (ram[current_free_node_index + 1] >= units) {
+                if (ram[current_free_node_index + 1] == units) {
+                    ram[previous_free_node_index] =
+                        ram[current_free_node_index];
+                    _last_free_block_index = ram[current_free_node_index];
+                } else {
+                    ram[current_free_node_index + 1] -= units;
+                    _last_free_block_index = current_free_node_index;
+                    current_free_node_index += 
+						ram[current_free_node_index + 1] + 2;
+                    ram[current_free_node_index + 1] = units - 2;
+                }
+				
+				//return physical address
+                Memory::ram_size_type address =
+                    current_free_node_index + 2;
+                SVM_TRACE(
+                    board.trace, Trace::Debug,
+                    Trace::Alloc, Trace::KERNEL_PROCESS,
+                    address, units - 2
+                );
+
+                return address;
+            }
+            if (current_free_node_index == _last_free_block_index) {
+                return NO_FREE_LARGE_ENOUGH_BLOCK;
+            }
         }
-         
-        return physical_index;
+
+        return NO_FREE_LARGE_ENOUGH_BLOCK;
     }
-	
-	bool Kernel::TryPageFault() {
-			bool is_there_free_memory = true;
-            std::cout << "Kernel: page fault." << std::endl;
-            
-            // Get the faulting page index from the register 'a'
-            auto faulting_page_index = board.cpu.registers.a;
-            // Try to acquire a new frame from the MMU by calling `AcquireFrame`
-            auto free_frame = board.memory.AcquireFrame();
-            
-            if (free_frame != Memory::INVALID_PAGE) {
-                // Write the frame to the current faulting page in the
-                // MMU page table (at index from register 'a')
-                board.memory.page_table->at(faulting_page_index) = free_frame;
-            } else {
-                // Notify the process or stop the board (out of
-                // physical memory)
-				is_there_free_memory = false;
-                std::cout << "Out of physical memory." << std::endl;
-                board.Stop();
+
+    void Kernel::FreeMemory(
+                     Memory::ram_size_type physical_address
+                 )
+    {
+        SVM_TRACE(
+            board.trace, Trace::Debug,
+            Trace::Free, Trace::KERNEL_PROCESS,
+            physical_address
+        );
+
+        Memory::ram_size_type index_of_used_block_header = physical_address - 2;
+        Memory::ram_size_type index_of_size_of_used_block = physical_address - 1;
+		
+		auto &ram = board.memory.ram;
+        
+        Memory::ram_size_type current_index_of_free_node;
+        for (current_index_of_free_node = _last_free_block_index;
+                !(index_of_used_block_header > current_index_of_free_node &&
+                index_of_used_block_header < ram[current_index_of_free_node]);
+                current_index_of_free_node = ram[current_index_of_free_node]) {
+            if (current_index_of_free_node >= ram[current_index_of_free_node] &&
+                (index_of_used_block_header > current_index_of_free_node ||
+                 index_of_used_block_header < ram[current_index_of_free_node])) {
+                    break;
+                }
+        }
+        
+		//try to merge with the right block
+        if (index_of_used_block_header + ram[index_of_size_of_used_block] + 2 ==
+			ram[current_index_of_free_node]) {
+            ram[index_of_size_of_used_block] += 
+				ram[ram[current_index_of_free_node] + 1] + 2;
+            ram[index_of_used_block_header] = 
+				ram[ram[current_index_of_free_node]];
+        } else {
+            ram[index_of_used_block_header] = 
+				ram[current_index_of_free_node];
+        }
+        
+        //try to merge with the left block
+        if (current_index_of_free_node + 
+			ram[current_index_of_free_node + 1] + 2 == index_of_used_block_header) {
+            ram[current_index_of_free_node + 1] += 
+				ram[index_of_size_of_used_block] + 2;
+            ram[current_index_of_free_node] = 
+				ram[index_of_used_block_header];
+        } else {
+            ram[current_index_of_free_node] = index_of_used_block_header;
+        }
+        
+        _last_free_block_index = current_index_of_free_node;
+
+        UpdateFragmentation();
+    }
+
+    void Kernel::UpdateFragmentation()
+    {
+        auto &ram = board.memory.ram;
+
+        Memory::ram_size_type free_words = 0, largest_block = 0, blocks = 0;
+        Memory::ram_size_type node = _last_free_block_index;
+        do {
+            Memory::ram_size_type size = ram[node + 1];
+            free_words += size;
+            largest_block = std::max(largest_block, size);
+            ++blocks;
+
+            node = ram[node];
+        } while (node != _last_free_block_index);
+
+        // Share of the free words outside of the largest hole
+        _compacting =
+            blocks > 1 &&
+            (free_words - largest_block) * 100 >
+                free_words * _FRAGMENTATION_THRESHOLD;
+    }
+
+    Process *Kernel::FindProcessByImage(Memory::ram_size_type address)
+    {
+        for (auto &process : processes) {
+            if (process.memory_start_position == address) {
+                return &process;
             }
-			
-			return is_there_free_memory;
-	}
+        }
+        for (auto &process : blocked) {
+            if (process.memory_start_position == address) {
+                return &process;
+            }
+        }
+        for (auto &process : suspended) {
+            if (process.memory_start_position == address) {
+                return &process;
+            }
+        }
+        for (auto &process : realtime) {
+            if (process.memory_start_position == address) {
+                return &process;
+            }
+        }
+
+        return NULL;
+    }
+
+    void Kernel::CompactMemoryStep()
+    {
+        if (!_compacting) {
+            return;
+        }
+
+        _compaction_credit += _COMPACTION_WORDS_PER_TICK;
+
+        auto &ram = board.memory.ram;
+
+        // Free blocks in address order, the list is circular and starts
+        //   anywhere
+        std::vector<Memory::ram_size_type> free_blocks;
+        Memory::ram_size_type node = _last_free_block_index;
+        do {
+            free_blocks.push_back(node);
+            node = ram[node];
+        } while (node != _last_free_block_index);
+        std::sort(free_blocks.begin(), free_blocks.end());
+
+        // Allocations carve the top of the holes, so blocks slide up
+        //   toward the other images and the holes sink to the bottom
+        for (std::size_t i = free_blocks.size(); i-- > 0; ) {
+            Memory::ram_size_type hole = free_blocks[i];
+            Memory::ram_size_type hole_size = ram[hole + 1];
+            Memory::ram_size_type next = ram[hole];
+
+            // Walk the used blocks from the previous hole up to this one
+            Memory::ram_size_type previous = NO_FREE_LARGE_ENOUGH_BLOCK;
+            Memory::ram_size_type block = 0;
+            if (i > 0) {
+                previous = free_blocks[i - 1];
+                block = previous + ram[previous + 1] + 2;
+            } else if (hole == 0) {
+                continue;
+            }
+            if (block >= hole) {
+                continue;
+            }
+            while (block + ram[block + 1] + 2 < hole) {
+                block += ram[block + 1] + 2;
+            }
+            if (block + ram[block + 1] + 2 != hole) {
+                continue;
+            }
+
+            // Slabs and other kernel objects are pinned
+            Process *owner = FindProcessByImage(block + 2);
+            if (owner == NULL) {
+                continue;
+            }
+
+            Memory::ram_size_type block_words = ram[block + 1] + 2;
+            if (_compaction_credit < block_words) {
+                return;
+            }
+            _compaction_credit -= block_words;
+
+            // The hole moves down behind the block (the heap is identity
+            //   mapped)
+            Memory::ram_size_type distance = hole_size + 2;
+            std::copy_backward(
+                ram.begin() + block,
+                ram.begin() + block + block_words,
+                ram.begin() + block + block_words + distance
+            );
+
+            Memory::ram_size_type moved_hole = block;
+            ram[moved_hole + 1] = hole_size;
+            if (next == hole) {
+                ram[moved_hole] = moved_hole;
+            } else {
+                ram[moved_hole] = next;
+                Memory::ram_size_type last = free_blocks.back();
+                Memory::ram_size_type previous_node =
+                    i > 0 ? free_blocks[i - 1] : last;
+                ram[previous_node] = moved_hole;
+            }
+            _last_free_block_index = moved_hole;
+
+            if (previous != NO_FREE_LARGE_ENOUGH_BLOCK &&
+                    previous + ram[previous + 1] + 2 == moved_hole) {
+                ram[previous + 1] += hole_size + 2;
+                ram[previous] = ram[moved_hole];
+                _last_free_block_index = previous;
+            }
+
+            // Code is fetched by physical address
+            owner->memory_start_position += distance;
+            owner->memory_end_position += distance;
+            Registers registers = owner->LoadRegisters(board.memory);
+            registers.ip += distance;
+            owner->StoreRegisters(board.memory, registers);
+            if (!board.cpu.halted && owner == &CurrentProcess()) {
+                board.cpu.registers.ip += distance;
+            }
+
+            _compacted_words += block_words;
+            ++_compacted_blocks;
+
+            UpdateFragmentation();
+
+            return;
+        }
+
+        // Only pinned blocks are left between the holes
+        _compacting = false;
+        _compaction_credit = 0;
+    }
+	
+
+	//translate from virtual to physical address
+	bool Kernel::TryPageFault() {
+			bool is_there_free_memory = true;
+            ++_page_faults;
+            
+            // Get the faulting page index from the register 'a'
+            auto faulting_page_index = board.cpu.registers.a;
+            Process &process = CurrentProcess();
+            ++process.page_faults;
+            StopAtEvent(PageFault, process.id);
+
+            // Page fault frequency: the allotment grows while faults are
+            //   frequent and shrinks to the working set otherwise. At its
+            //   allotment the process replaces one of its own pages
+            UpdateAllotment(process);
+            if (CountResidentPages(process) >= process.allotment) {
+                EvictOldestPage(process);
+            }
+
+            // Try to acquire a new frame from the MMU by calling `AcquireFrame`
+            //   (pages of mapped files and the swap space are read in)
+            auto free_frame =
+                AcquireProcessFrame(process, faulting_page_index);
+            if (free_frame == Memory::INVALID_PAGE && EvictOldestPage(process)) {
+                free_frame = AcquireProcessFrame(process, faulting_page_index);
+            }
+
+            SVM_TRACE(
+                board.trace, Trace::Info,
+                Trace::PageFault, CurrentProcess().id,
+                faulting_page_index, static_cast<long long>(free_frame)
+            );
+            
+            if (free_frame != Memory::INVALID_PAGE) {
+                // Write the frame to the current faulting page in the
+                // MMU page table (at index from register 'a')
+                board.memory.SetPageEntry(
+                    board.memory.page_table,
+                    faulting_page_index,
+                    free_frame
+                );
+            } else if (processes.size() + blocked.size() + realtime.size() > 1) {
+                // The others hold every frame, the process is suspended at
+                //   the next tick (not in the middle of the instruction)
+                _out_of_frames = true;
+            } else {
+                // Notify the process or stop the board (out of
+                // physical memory)
+				is_there_free_memory = false;
+                SVM_TRACE(
+                    board.trace, Trace::Errors,
+                    Trace::OutOfMemory, CurrentProcess().id,
+                    faulting_page_index
+                );
+                std::cerr << "Kernel: out of physical memory." << std::endl;
+                StopMachine();
+            }
+			
+			return is_there_free_memory;
+	}
+
+    Memory::ram_size_type Kernel::TranslateProcessAddress(
+                                      const Process &process,
+                                      Memory::vmem_size_type virtual_address
+                                  )
+    {
+        Memory::page_index_offset_pair_type page_index_offset_pair =
+            board.memory.GetPageIndexAndOffsetForVirtualAddress(virtual_address);
+
+        if (page_index_offset_pair.first >= Memory::PAGE_TABLE_SIZE) {
+            return Memory::INVALID_PAGE;
+        }
+
+        Memory::page_entry_type page_frame_index =
+            board.memory.GetPageEntry(
+                process.page_table,
+                page_index_offset_pair.first
+            );
+        if (page_frame_index == Memory::INVALID_PAGE) {
+            page_frame_index =
+                AcquireProcessFrame(process, page_index_offset_pair.first);
+            if (page_frame_index == Memory::INVALID_PAGE) {
+                return Memory::INVALID_PAGE;
+            }
+            board.memory.SetPageEntry(
+                process.page_table,
+                page_index_offset_pair.first,
+                page_frame_index
+            );
+        }
+
+        return page_index_offset_pair.second +
+                   Memory::PAGE_SIZE * page_frame_index;
+    }
+
+    Process &Kernel::CurrentProcess()
+    {
+        return _running_realtime ?
+                   realtime.front() : processes[_current_process_index];
+    }
+
+    void Kernel::SaveCurrentProcess(Process::States state)
+    {
+        Process &process = CurrentProcess();
+
+        process.StoreRegisters(board.memory, board.cpu.registers);
+        process.state = state;
+
+        ChargeCurrentProcess();
+    }
+
+    void Kernel::ChargeCurrentProcess()
+    {
+        Process &process = CurrentProcess();
+
+        process.run_cycles += board.cycles - _dispatch_cycle;
+        _dispatch_cycle = board.cycles;
+        process.instructions +=
+            board.cpu.instructions - _dispatch_instructions;
+        _dispatch_instructions = board.cpu.instructions;
+    }
+
+    void Kernel::SwitchToCurrentProcess()
+    {
+        Process &process = CurrentProcess();
+
+        board.memory.page_table = process.page_table;
+        board.cpu.registers = process.LoadRegisters(board.memory);
+        board.cpu.verified = process.verified;
+        board.cpu.halted = false;
+        process.state = Process::States::Running;
+        _dispatch_cycle = board.cycles;
+        _dispatch_instructions = board.cpu.instructions;
+        ++process.context_switches;
+        if (board.cpu.cache) {
+            board.cache.SetContext(process.id);
+        }
+
+        SVM_TRACE(
+            board.trace, Trace::Info,
+            Trace::ContextSwitch, process.id,
+            board.cpu.registers.ip - process.memory_start_position
+        );
+
+        _cycles_passed_after_preemption = 0;
+    }
+
+    void Kernel::EnqueueProcess(Process &process)
+    {
+        process.state = Process::States::Ready;
+
+        if (process.period > 0) {
+            // Preemptive, the earliest deadline always runs. The callers
+            //   switch when the CPU was idle
+            ReleaseJobs(process);
+
+            bool was_running = !board.cpu.halted;
+            if (was_running) {
+                SaveCurrentProcess(Process::States::Ready);
+            }
+
+            realtime.push_back(process);
+            std::push_heap(realtime.begin(), realtime.end(), HasLaterDeadline);
+            _running_realtime = true;
+
+            if (was_running) {
+                SwitchToCurrentProcess();
+            }
+
+            return;
+        }
+
+        if (scheduler == FirstComeFirstServed || scheduler == RoundRobin) {
+            processes.push_back(process);
+        } else if (scheduler == ShortestJob) {
+            // Non-preemptive, the running process stays in front
+            auto first = processes.begin();
+            if (!board.cpu.halted && !processes.empty()) {
+                ++first;
+            }
+            processes.insert(
+                std::upper_bound(
+                    first,
+                    processes.end(),
+                    process,
+                    [](const Process& p1, const Process& p2) {
+                        return p1.sequential_instruction_count <
+                            p2.sequential_instruction_count;
+                    }
+                ),
+                process
+            );
+        } else if (scheduler == Priority) {
+            // Preemptive, the top of the heap always runs (once the
+            //   real-time class leaves the CPU)
+            bool was_running = !board.cpu.halted && !_running_realtime;
+            if (was_running) {
+                SaveCurrentProcess(Process::States::Ready);
+            }
+
+            processes.push_back(process);
+            std::push_heap(processes.begin(), processes.end());
+
+            if (was_running) {
+                _current_process_index = 0;
+                SwitchToCurrentProcess();
+            }
+        }
+    }
+
+    void Kernel::RemoveCurrentProcess()
+    {
+        if (_running_realtime) {
+            std::pop_heap(realtime.begin(), realtime.end(), HasLaterDeadline);
+            realtime.pop_back();
+            _running_realtime = false;
+        } else if (scheduler == Priority) {
+            std::pop_heap(processes.begin(), processes.end());
+            processes.pop_back();
+        } else {
+            processes.erase(processes.begin() + _current_process_index);
+        }
+
+        // Round Robin continues with the process that followed the removed
+        //   one, the other schedulers always run the first one
+        if (_current_process_index >= processes.size()) {
+            _current_process_index = 0;
+        }
+
+        bool can_wake_up =
+            !blocked.empty() &&
+            (blocked.size() > _ipc.CountReceivers() || _timers.GetCount() > 0);
+        if (processes.empty() && realtime.empty()) {
+            // The frames may be free now. With nothing else to run, the
+            //   suspended and held back processes get them anyway
+            board.cpu.halted = true;
+            AdmitProcesses(!can_wake_up);
+        }
+
+        if (!realtime.empty()) {
+            _running_realtime = true;
+            SwitchToCurrentProcess();
+        } else if (!processes.empty()) {
+            // A process preempted by the real-time class continues
+            SwitchToCurrentProcess();
+        } else if (can_wake_up || !_replayed_admissions.empty()) {
+            // Idle until a device completes a request or the replay loads
+            //   the next image
+            board.cpu.halted = true;
+        } else if (!blocked.empty()) {
+            // Only a running process could send the messages
+            std::cerr << "Kernel: every process waits for a message."
+                      << std::endl;
+            StopMachine();
+        } else {
+            // A host may still load more
+            board.Stop();
+        }
+    }
+
+    void Kernel::TerminateCurrentProcess()
+    {
+        Process &process = CurrentProcess();
+        StopAtEvent(ProcessExit, process.id);
+
+        // Unload the current process
+        // release data in RAM
+        ReleaseProcessMemory(process);
+
+        RemoveCurrentProcess();
+    }
+
+    void Kernel::BlockCurrentProcess()
+    {
+        SaveCurrentProcess(Process::States::Blocked);
+        blocked.push_back(CurrentProcess());
+
+        RemoveCurrentProcess();
+    }
+
+    void Kernel::UnblockProcess(process_list_type::iterator process)
+    {
+        Process ready_process = *process;
+        blocked.erase(process);
+
+        // Woken up by something else than its timeout
+        if (ready_process.timer != TimerWheel::NO_TIMER) {
+            _timers.Cancel(ready_process.timer);
+            ready_process.timer = TimerWheel::NO_TIMER;
+        }
+
+        bool was_idle = board.cpu.halted;
+
+        EnqueueProcess(ready_process);
+
+        if (was_idle) {
+            _current_process_index = 0;
+            SwitchToCurrentProcess();
+        }
+    }
+
+    void Kernel::SubmitDiskRequest(Disk::Operations operation)
+    {
+        auto &registers = board.cpu.registers;
+
+        if (!board.disk.IsOpen()) {
+            registers.a = -1;
+            return;
+        }
+
+        // The host seeks to the block, a negative or huge number would
+        //   grow the image by gigabytes
+        if (registers.a < 0 ||
+                static_cast<Disk::block_index_type>(registers.a) >=
+                    Disk::MAX_BLOCKS) {
+            registers.a = -1;
+            return;
+        }
+
+        Process &process = CurrentProcess();
+
+        Disk::Request request;
+        request.operation = operation;
+        request.block = registers.a;
+        request.process_id = process.id;
+        request.virtual_address = registers.b;
+        request.buffer.resize(Disk::BLOCK_SIZE);
+
+        // Map the whole buffer now, the completion may arrive when another
+        //   process is on the CPU
+        for (Memory::ram_size_type i = 0; i < Disk::BLOCK_SIZE; ++i) {
+            auto physical_address =
+                TranslateProcessAddress(
+                    process,
+                    request.virtual_address + i
+                );
+            if (physical_address == Memory::INVALID_PAGE) {
+                registers.a = -1;
+                return;
+            }
+
+            if (operation == Disk::Write) {
+                request.buffer[i] = board.memory.ram[physical_address];
+            }
+        }
+
+        if (_event_log.IsReplaying()) {
+            EventLog::Event event;
+            if (_event_log.Next(EventLog::DiskCompletion, event)) {
+                request.completion_cycle = event.cycle;
+                _replayed_disk_completions.push_back(event);
+            } else {
+                // The run went past the recording
+                request.completion_cycle =
+                    board.disk.GetPassedCyclesCount() + board.disk.latency;
+            }
+        }
+
+        if (_batch_result_address != Memory::INVALID_PAGE) {
+            // The batch blocks once after every entry is submitted
+            request.result_address = _batch_result_address;
+            ++process.pending_requests;
+            board.disk.Submit(request);
+
+            registers.a = 0;
+            return;
+        }
+
+        board.disk.Submit(request);
+
+        BlockCurrentProcess();
+    }
+
+    void Kernel::CompleteDiskRequests()
+    {
+        Disk::Request request;
+        while (board.disk.TryGetCompletion(request)) {
+            if (!_replayed_disk_completions.empty()) {
+                // Use the recorded result, the image may have changed since
+                EventLog::Event &event = _replayed_disk_completions.front();
+                request.succeeded = event.value != 0;
+                if (request.operation == Disk::Read &&
+                        event.words.size() == request.buffer.size()) {
+                    request.buffer = event.words;
+                }
+
+                _replayed_disk_completions.pop_front();
+            }
+
+            if (_event_log.IsRecording()) {
+                EventLog::Event event;
+                event.type = EventLog::DiskCompletion;
+                event.cycle = request.completion_cycle;
+                event.value = request.succeeded ? 1 : 0;
+                if (request.operation == Disk::Read) {
+                    event.words = request.buffer;
+                }
+
+                _event_log.Record(event);
+            }
+
+            auto process =
+                std::find_if(
+                    blocked.begin(),
+                    blocked.end(),
+                    [&](const Process &process) {
+                        return process.id == request.process_id;
+                    }
+                );
+            if (process == blocked.end()) {
+                continue;
+            }
+
+            if (request.operation == Disk::Read && request.succeeded) {
+                // Pages of the buffer may have been evicted while the
+                //   process waited, mapping them again can fail
+                for (Memory::ram_size_type i = 0; i < Disk::BLOCK_SIZE; ++i) {
+                    auto physical_address =
+                        TranslateProcessAddress(
+                            *process,
+                            request.virtual_address + i
+                        );
+                    if (physical_address == Memory::INVALID_PAGE) {
+                        request.succeeded = false;
+                        break;
+                    }
+                    board.memory.ram[physical_address] = request.buffer[i];
+                }
+            }
+
+            if (request.result_address == Memory::INVALID_PAGE) {
+                Registers registers = process->LoadRegisters(board.memory);
+                registers.a = request.succeeded ? 0 : -1;
+                process->StoreRegisters(board.memory, registers);
+            } else {
+                // `a` of the batch already has the number of entries
+                board.memory.ram[request.result_address] =
+                    request.succeeded ? 0 : -1;
+                if (--process->pending_requests > 0) {
+                    continue;
+                }
+            }
+
+            UnblockProcess(process);
+        }
+    }
+
+    void Kernel::ReadInput()
+    {
+        auto &registers = board.cpu.registers;
+
+        if (registers.b <= 0 || !board.keyboard.IsOpen()) {
+            registers.a = -1;
+            return;
+        }
+
+        if (board.keyboard.IsAtEnd()) {
+            registers.a = 0;
+            RecordInput(Memory::ram_type());
+            return;
+        }
+
+        Process &process = CurrentProcess();
+        int words_count = DeliverInput(process, registers.a, registers.b);
+        if (words_count != 0) {
+            registers.a = words_count;
+            return;
+        }
+
+        if (!ArmTimeout(process, InputTimer)) {
+            registers.a = -1;
+            return;
+        }
+
+        // IRQ 1 delivers the input when it arrives
+        _input_readers.push_back(process.id);
+        BlockCurrentProcess();
+    }
+
+    void Kernel::CompleteInputReads()
+    {
+        while (!_input_readers.empty()) {
+            auto reader =
+                std::find_if(
+                    blocked.begin(),
+                    blocked.end(),
+                    [&](const Process &process) {
+                        return process.id == _input_readers.front();
+                    }
+                );
+            if (reader == blocked.end()) {
+                _input_readers.pop_front();
+                continue;
+            }
+
+            Registers registers = reader->LoadRegisters(board.memory);
+            if (board.keyboard.IsAtEnd()) {
+                registers.a = 0;
+                RecordInput(Memory::ram_type());
+            } else {
+                int words_count =
+                    DeliverInput(*reader, registers.a, registers.b);
+                if (words_count == 0) {
+                    break;
+                }
+                registers.a = words_count;
+            }
+            reader->StoreRegisters(board.memory, registers);
+
+            _input_readers.pop_front();
+            UnblockProcess(reader);
+        }
+    }
+
+    int Kernel::DeliverInput(
+                    Process &process,
+                    Memory::vmem_size_type buffer,
+                    int capacity
+                )
+    {
+        Memory::ram_type words;
+        int word;
+        while (static_cast<int>(words.size()) < capacity) {
+            auto physical_address =
+                TranslateProcessAddress(
+                    process,
+                    buffer + words.size()
+                );
+            if (physical_address == Memory::INVALID_PAGE ||
+                    !board.keyboard.TryRead(word)) {
+                break;
+            }
+
+            board.memory.ram[physical_address] = word;
+            words.push_back(word);
+        }
+
+        if (!words.empty()) {
+            RecordInput(words);
+        }
+
+        return static_cast<int>(words.size());
+    }
+
+    void Kernel::RecordInput(const Memory::ram_type &words)
+    {
+        if (!_event_log.IsRecording()) {
+            return;
+        }
+
+        EventLog::Event event;
+        event.type = EventLog::HostInput;
+        event.cycle = board.cycles;
+        event.value = static_cast<int>(words.size());
+        event.words = words;
+
+        _event_log.Record(event);
+    }
+
+    void Kernel::Sleep()
+    {
+        auto &registers = board.cpu.registers;
+
+        if (registers.a <= 0) {
+            registers.a = 0;
+            return;
+        }
+
+        Process &process = CurrentProcess();
+        process.timer =
+            _timers.Add(board.cycles + registers.a, process.id, SleepTimer);
+        if (process.timer == TimerWheel::NO_TIMER) {
+            registers.a = -1;
+            return;
+        }
+
+        registers.a = 0;
+        BlockCurrentProcess();
+    }
+
+    void Kernel::SetTimeout()
+    {
+        auto &registers = board.cpu.registers;
+
+        if (registers.a < 0) {
+            registers.a = -1;
+            return;
+        }
+
+        CurrentProcess().timeout = registers.a;
+        registers.a = 0;
+    }
+
+    void Kernel::ReadCounters()
+    {
+        auto &registers = board.cpu.registers;
+
+        // Up to the `int`, the process stays on the CPU
+        ChargeCurrentProcess();
+
+        Process &process = CurrentProcess();
+        const unsigned long long counters[] = {
+            process.instructions,
+            process.page_faults,
+            process.context_switches,
+            process.run_cycles
+        };
+        const int counters_count =
+            static_cast<int>(sizeof(counters) / sizeof(counters[0]));
+
+        Memory::ram_size_type physical_addresses[counters_count];
+        for (int i = 0; i < counters_count; ++i) {
+            physical_addresses[i] =
+                TranslateProcessAddress(process, registers.a + i);
+            if (physical_addresses[i] == Memory::INVALID_PAGE) {
+                registers.a = -1;
+                return;
+            }
+        }
+        for (int i = 0; i < counters_count; ++i) {
+            board.memory.ram[physical_addresses[i]] =
+                static_cast<int>(counters[i]);
+        }
+
+        registers.a = counters_count;
+    }
+
+    bool Kernel::ArmTimeout(Process &process, TimerKinds kind)
+    {
+        if (process.timeout > 0) {
+            process.timer =
+                _timers.Add(board.cycles + process.timeout, process.id, kind);
+        }
+
+        return process.timeout <= 0 || process.timer != TimerWheel::NO_TIMER;
+    }
+
+    void Kernel::ExpireTimers()
+    {
+        _expired_timers.clear();
+        _timers.Advance(board.cycles, _expired_timers);
+
+        for (auto &timer : _expired_timers) {
+            auto process =
+                std::find_if(
+                    blocked.begin(),
+                    blocked.end(),
+                    [&](const Process &blocked_process) {
+                        return blocked_process.id == timer.owner;
+                    }
+                );
+            if (process == blocked.end()) {
+                continue;
+            }
+            process->timer = TimerWheel::NO_TIMER;
+
+            Registers registers = process->LoadRegisters(board.memory);
+            if (timer.kind == SleepTimer) {
+                registers.a = 0;
+            } else if (timer.kind == ReleaseTimer) {
+                // The registers of a throttled job stay as they were
+            } else {
+                // The call gives up, the key of `receive` is still in `a`
+                std::deque<Process::process_id_type> &waiters =
+                    timer.kind == ReceiveTimer ?
+                        _ipc.mailboxes[registers.a].receivers :
+                        _input_readers;
+                waiters.erase(
+                    std::remove(waiters.begin(), waiters.end(), process->id),
+                    waiters.end()
+                );
+
+                registers.a = TIMED_OUT;
+            }
+            process->StoreRegisters(board.memory, registers);
+
+            UnblockProcess(process);
+        }
+    }
+
+    void Kernel::SetRealtime()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        if (registers.a <= 0 || registers.b <= 0 || registers.c <= 0 ||
+                registers.c > registers.b || registers.b > registers.a) {
+            registers.a = -1;
+            return;
+        }
+
+        // Admission: EDF meets every deadline while the densities add up
+        //   to the whole CPU at most
+        double density = static_cast<double>(registers.c) / registers.b;
+        for (auto process_list : { &realtime, &blocked, &suspended }) {
+            for (auto &another_process : *process_list) {
+                if (another_process.period > 0 &&
+                        another_process.id != process.id) {
+                    density +=
+                        static_cast<double>(another_process.budget) /
+                            another_process.relative_deadline;
+                }
+            }
+        }
+        if (density > 1.0) {
+            registers.a = -1;
+            return;
+        }
+
+        // A new job is released now with the new parameters
+        process.period = static_cast<unsigned long long>(registers.a);
+        process.relative_deadline = static_cast<unsigned long long>(registers.b);
+        process.budget = static_cast<unsigned long long>(registers.c);
+        process.release = board.cycles;
+        process.job_done = true;
+        registers.a = 0;
+
+        bool was_realtime = _running_realtime;
+        SaveCurrentProcess(Process::States::Ready);
+        ReleaseJobs(process);
+
+        if (was_realtime) {
+            std::make_heap(realtime.begin(), realtime.end(), HasLaterDeadline);
+        } else {
+            // Moves from the normal class, no other real-time process is
+            //   ready while a normal one runs
+            Process realtime_process = process;
+            if (scheduler == Priority) {
+                std::pop_heap(processes.begin(), processes.end());
+                processes.pop_back();
+            } else {
+                processes.erase(processes.begin() + _current_process_index);
+            }
+            if (_current_process_index >= processes.size()) {
+                _current_process_index = 0;
+            }
+
+            realtime.push_back(realtime_process);
+            std::push_heap(realtime.begin(), realtime.end(), HasLaterDeadline);
+            _running_realtime = true;
+        }
+
+        SwitchToCurrentProcess();
+    }
+
+    void Kernel::WaitForNextPeriod()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        if (process.period == 0) {
+            registers.a = -1;
+            return;
+        }
+
+        Board::cycles_type release =
+            process.release > board.cycles ?
+                process.release : board.cycles + 1;
+        process.timer = _timers.Add(release, process.id, ReleaseTimer);
+        if (process.timer == TimerWheel::NO_TIMER) {
+            registers.a = -1;
+            return;
+        }
+
+        if (board.cycles > process.deadline) {
+            ++process.deadline_misses;
+            ++_deadline_misses;
+            StopAtEvent(DeadlineMiss, process.id);
+        }
+        process.job_done = true;
+
+        registers.a = 0;
+        BlockCurrentProcess();
+    }
+
+    bool Kernel::ReleaseJobs(Process &process)
+    {
+        if (process.period == 0 || board.cycles < process.release) {
+            return false;
+        }
+
+        // Every period that started is a job, the ones that did not run
+        //   to the end missed their deadlines
+        unsigned long long jobs_count =
+            (board.cycles - process.release) / process.period + 1;
+        unsigned long long misses_count =
+            process.job_done ? jobs_count - 1 : jobs_count;
+        process.deadline_misses += misses_count;
+        _deadline_misses += misses_count;
+        if (misses_count > 0) {
+            StopAtEvent(DeadlineMiss, process.id);
+        }
+        _realtime_jobs += jobs_count;
+
+        process.release += jobs_count * process.period;
+        process.deadline =
+            process.release - process.period + process.relative_deadline;
+        process.job_start = process.run_cycles;
+        process.job_done = false;
+
+        return true;
+    }
+
+    void Kernel::EnforceBudgets()
+    {
+        if (!_running_realtime || board.cpu.halted) {
+            return;
+        }
+
+        // The running job is charged up to now
+        ChargeCurrentProcess();
+
+        bool released = false;
+        for (auto &process : realtime) {
+            if (ReleaseJobs(process)) {
+                released = true;
+            }
+        }
+        if (released) {
+            SaveCurrentProcess(Process::States::Ready);
+            std::make_heap(realtime.begin(), realtime.end(), HasLaterDeadline);
+            SwitchToCurrentProcess();
+        }
+
+        // Out of budget, the job continues at the next release (the next
+        //   tick tries again without kernel memory for the timer)
+        Process &process = CurrentProcess();
+        if (process.run_cycles - process.job_start >= process.budget) {
+            process.timer =
+                _timers.Add(process.release, process.id, ReleaseTimer);
+            if (process.timer != TimerWheel::NO_TIMER) {
+                BlockCurrentProcess();
+            }
+        }
+    }
+
+    bool Kernel::HasLaterDeadline(
+                     const Process &process,
+                     const Process &another_process
+                 )
+    {
+        return process.deadline > another_process.deadline ||
+                   (process.deadline == another_process.deadline &&
+                        process.id > another_process.id);
+    }
+
+    void Kernel::SubmitBatch()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        if (registers.b <= 0 || registers.a < 0 ||
+                static_cast<Memory::vmem_size_type>(registers.b) >
+                    SyscallTable::MAX_BATCH_ENTRIES) {
+            registers.a = -1;
+            return;
+        }
+
+        // Map every entry first, a batch that can not be read runs nothing
+        Memory::vmem_size_type entries_count = registers.b;
+        std::vector<Memory::ram_size_type> entries;
+        for (Memory::vmem_size_type i = 0;
+                 i < entries_count * SyscallTable::BATCH_ENTRY_SIZE; ++i) {
+            auto physical_address =
+                TranslateProcessAddress(
+                    process,
+                    registers.a + i
+                );
+            if (physical_address == Memory::INVALID_PAGE) {
+                registers.a = -1;
+                return;
+            }
+            entries.push_back(physical_address);
+        }
+
+        Registers caller = registers;
+
+        auto &ram = board.memory.ram;
+        for (Memory::vmem_size_type i = 0; i < entries.size();
+                 i += SyscallTable::BATCH_ENTRY_SIZE) {
+            int number = ram[entries[i]];
+            if (!_syscalls.IsBatchable(number)) {
+                ram[entries[i + 1]] = -1;
+                continue;
+            }
+
+            registers.a = ram[entries[i + 1]];
+            registers.b = ram[entries[i + 2]];
+            registers.c = ram[entries[i + 3]];
+
+            _batch_result_address = entries[i + 1];
+            _syscalls.Dispatch(number);
+            _batch_result_address = Memory::INVALID_PAGE;
+
+            ram[entries[i + 1]] = registers.a;
+        }
+
+        registers = caller;
+        registers.a = static_cast<int>(entries_count);
+
+        if (process.pending_requests > 0) {
+            BlockCurrentProcess();
+        }
+    }
+
+    bool Kernel::GetPageRange(
+                     const Process &process,
+                     Memory::page_table_size_type &first_page,
+                     Memory::page_table_size_type &pages_count
+                 )
+    {
+        const auto &registers = board.cpu.registers;
+        if (registers.c <= 0 || registers.b < 0 ||
+                registers.b % Memory::PAGE_SIZE != 0) {
+            return false;
+        }
+
+        first_page = registers.b / Memory::PAGE_SIZE;
+        pages_count = registers.c;
+
+        // Regions of mapped files are changed by `mmap`/`munmap` only
+        return first_page + pages_count <= Memory::PAGE_TABLE_SIZE &&
+                   !_mappings.Overlaps(process.id, first_page, pages_count);
+    }
+
+    void Kernel::AttachSharedSegment()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        Memory::page_table_size_type first_page, pages_count;
+        if (!GetPageRange(process, first_page, pages_count)) {
+            registers.a = -1;
+            return;
+        }
+
+        auto existing_segment = _ipc.segments.find(registers.a);
+        if (existing_segment == _ipc.segments.end()) {
+            if (board.memory.GetFreeFramesCount() < pages_count) {
+                registers.a = -1;
+                return;
+            }
+
+            IPC::Segment segment;
+            for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+                segment.frames.push_back(AcquireZeroedFrame());
+            }
+            existing_segment =
+                _ipc.segments.insert(
+                    std::make_pair(registers.a, segment)
+                ).first;
+            for (auto frame : segment.frames) {
+                _ipc.shared_frames[frame] = registers.a;
+            }
+        }
+
+        IPC::Segment &segment = existing_segment->second;
+        if (pages_count > segment.frames.size()) {
+            registers.a = -1;
+            return;
+        }
+
+        // A second attachment would be counted twice at exit
+        for (Memory::page_table_size_type page = 0;
+                 page < Memory::PAGE_TABLE_SIZE; ++page) {
+            auto shared_frame =
+                _ipc.shared_frames.find(
+                    board.memory.GetPageEntry(process.page_table, page)
+                );
+            if (shared_frame != _ipc.shared_frames.end() &&
+                    shared_frame->second == registers.a) {
+                registers.a = -1;
+                return;
+            }
+        }
+
+        // Private pages under the segment are replaced
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry != Memory::INVALID_PAGE &&
+                    _ipc.shared_frames.count(entry) > 0) {
+                registers.a = -1;
+                return;
+            }
+        }
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry != Memory::INVALID_PAGE) {
+                board.memory.ReleaseFrame(entry);
+            }
+            board.memory.SetPageEntry(
+                process.page_table,
+                first_page + i,
+                segment.frames[i]
+            );
+        }
+        ++segment.attachments;
+
+        registers.a = 0;
+    }
+
+    void Kernel::MapFile()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        unsigned int file =
+            static_cast<unsigned int>(registers.a) &
+                (FileMappings::MAX_FILES - 1);
+        FileMappings::page_type file_page =
+            static_cast<unsigned int>(registers.a) >> FileMappings::FILE_BITS;
+
+        Memory::page_table_size_type first_page, pages_count;
+        if (registers.a < 0 || file >= _mappings.GetFilesCount() ||
+                !GetPageRange(process, first_page, pages_count) ||
+                file_page + pages_count > _mappings.GetFilePagesCount(file)) {
+            registers.a = -1;
+            return;
+        }
+
+        // Private pages under the region are replaced, the pages of the
+        //   file are read in on the first access
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry != Memory::INVALID_PAGE &&
+                    _ipc.shared_frames.count(entry) > 0) {
+                registers.a = -1;
+                return;
+            }
+        }
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry != Memory::INVALID_PAGE) {
+                board.memory.ReleaseFrame(entry);
+                board.memory.SetPageEntry(
+                    process.page_table,
+                    first_page + i,
+                    static_cast<Memory::page_entry_type>(Memory::INVALID_PAGE)
+                );
+            }
+            _swap.Discard(process.id, first_page + i);
+        }
+
+        FileMappings::Mapping mapping;
+        mapping.process_id = process.id;
+        mapping.file = file;
+        mapping.first_page = first_page;
+        mapping.pages_count = pages_count;
+        mapping.file_page = file_page;
+        _mappings.mappings.push_back(mapping);
+
+        registers.a = 0;
+    }
+
+    void Kernel::UnmapFile()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        auto mapping =
+            std::find_if(
+                _mappings.mappings.begin(),
+                _mappings.mappings.end(),
+                [&](const FileMappings::Mapping &process_mapping) {
+                    return process_mapping.process_id == process.id &&
+                               process_mapping.first_page * Memory::PAGE_SIZE ==
+                                   static_cast<unsigned int>(registers.a);
+                }
+            );
+        if (registers.a < 0 || mapping == _mappings.mappings.end()) {
+            registers.a = -1;
+            return;
+        }
+
+        registers.a = UnmapRegion(process, mapping) ? 0 : -1;
+    }
+
+    bool Kernel::UnmapRegion(
+                     Process &process,
+                     std::vector<FileMappings::Mapping>::iterator mapping
+                 )
+    {
+        bool written = true;
+
+        for (Memory::page_table_size_type page = mapping->first_page;
+                 page < mapping->first_page + mapping->pages_count; ++page) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, page);
+            if (entry == Memory::INVALID_PAGE) {
+                continue;
+            }
+
+            if (!_mappings.WritePage(
+                     *mapping,
+                     page,
+                     &board.memory.ram[entry * Memory::PAGE_SIZE]
+                 )) {
+                written = false;
+            }
+            board.memory.ReleaseFrame(entry);
+            board.memory.SetPageEntry(
+                process.page_table,
+                page,
+                static_cast<Memory::page_entry_type>(Memory::INVALID_PAGE)
+            );
+        }
+        _mappings.mappings.erase(mapping);
+
+        if (!written) {
+            std::cerr << "Kernel: failed to write a mapped file back."
+                      << std::endl;
+        }
+
+        return written;
+    }
+
+    void Kernel::SendMessage()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        Memory::page_table_size_type first_page, pages_count;
+        if (!GetPageRange(process, first_page, pages_count) ||
+                pages_count > IPC::MAX_MESSAGE_PAGES) {
+            registers.a = -1;
+            return;
+        }
+
+        // Shared pages can not move, pages never touched are sent zeroed
+        Memory::page_table_size_type unmapped_pages = 0;
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry == Memory::INVALID_PAGE) {
+                ++unmapped_pages;
+            } else if (_ipc.shared_frames.count(entry) > 0) {
+                registers.a = -1;
+                return;
+            }
+        }
+        if (board.memory.GetFreeFramesCount() < unmapped_pages) {
+            registers.a = -1;
+            return;
+        }
+
+        Memory::ram_size_type message = _message_cache.Allocate();
+        if (message == SlabCache::NO_OBJECT) {
+            registers.a = -1;
+            return;
+        }
+
+        auto &ram = board.memory.ram;
+        ram[message] = pages_count;
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry == Memory::INVALID_PAGE) {
+                entry = AcquireProcessFrame(process, first_page + i);
+            }
+            ram[message + 1 + i] = entry;
+            board.memory.SetPageEntry(
+                process.page_table,
+                first_page + i,
+                static_cast<Memory::page_entry_type>(Memory::INVALID_PAGE)
+            );
+        }
+
+        IPC::key_type key = registers.a;
+        registers.a = 0;
+
+        IPC::Mailbox &mailbox = _ipc.mailboxes[key];
+        for (auto receiver_id = mailbox.receivers.begin();
+                 receiver_id != mailbox.receivers.end(); ++receiver_id) {
+            auto receiver =
+                std::find_if(
+                    blocked.begin(),
+                    blocked.end(),
+                    [&](const Process &blocked_process) {
+                        return blocked_process.id == *receiver_id;
+                    }
+                );
+            if (receiver == blocked.end()) {
+                continue;
+            }
+            Registers registers = receiver->LoadRegisters(board.memory);
+            if (registers.c < ram[message]) {
+                continue;
+            }
+
+            mailbox.receivers.erase(receiver_id);
+            registers.a = MapMessage(*receiver, registers.b, message);
+            receiver->StoreRegisters(board.memory, registers);
+            UnblockProcess(receiver);
+
+            return;
+        }
+
+        mailbox.messages.push_back(message);
+    }
+
+    void Kernel::ReceiveMessage()
+    {
+        auto &registers = board.cpu.registers;
+        Process &process = CurrentProcess();
+
+        Memory::page_table_size_type first_page, pages_count;
+        if (!GetPageRange(process, first_page, pages_count)) {
+            registers.a = -1;
+            return;
+        }
+        for (Memory::page_table_size_type i = 0; i < pages_count; ++i) {
+            if (_ipc.shared_frames.count(
+                    board.memory.GetPageEntry(process.page_table, first_page + i)
+                ) > 0) {
+                registers.a = -1;
+                return;
+            }
+        }
+
+        IPC::Mailbox &mailbox = _ipc.mailboxes[registers.a];
+        if (mailbox.messages.empty()) {
+            if (!ArmTimeout(process, ReceiveTimer)) {
+                registers.a = -1;
+                return;
+            }
+
+            // The sender maps the message and wakes the process up
+            mailbox.receivers.push_back(process.id);
+            BlockCurrentProcess();
+
+            return;
+        }
+
+        if (static_cast<Memory::page_table_size_type>(
+                board.memory.ram[mailbox.messages.front()]
+            ) > pages_count) {
+            registers.a = -1;
+            return;
+        }
+
+        registers.a =
+            MapMessage(process, registers.b, mailbox.messages.front());
+        mailbox.messages.pop_front();
+    }
+
+    int Kernel::MapMessage(
+                    Process &process,
+                    Memory::vmem_size_type virtual_address,
+                    Memory::ram_size_type message
+                )
+    {
+        auto &ram = board.memory.ram;
+        int pages_count = ram[message];
+
+        Memory::page_table_size_type first_page =
+            virtual_address / Memory::PAGE_SIZE;
+        for (int i = 0; i < pages_count; ++i) {
+            Memory::page_entry_type entry =
+                board.memory.GetPageEntry(process.page_table, first_page + i);
+            if (entry != Memory::INVALID_PAGE) {
+                board.memory.ReleaseFrame(entry);
+            }
+            _swap.Discard(process.id, first_page + i);
+            board.memory.SetPageEntry(
+                process.page_table,
+                first_page + i,
+                ram[message + 1 + i]
+            );
+
+            // Back to the constructed state for the cache
+            ram[message + 1 + i] = static_cast<int>(Memory::INVALID_PAGE);
+        }
+        ram[message] = 0;
+
+        _message_cache.Free(message);
+
+        return pages_count;
+    }
+
+    Board::cycles_type Kernel::CyclesUntilNextEvent()
+    {
+        // The heap compactor makes use of idle ticks
+        if (_compacting) {
+            return 0;
+        }
+
+        // Periodic timer ticks are not events while idle, there is nothing
+        //   to preempt, but process timers are
+        Board::cycles_type next_completion =
+            board.disk.CyclesUntilNextCompletion();
+        if (_timers.GetCount() > 0) {
+            Board::cycles_type next_expiry =
+                _timers.GetCurrentCycle() + _timers.CyclesUntilNextExpiry();
+            if (next_expiry <= board.cycles) {
+                return 0;
+            }
+            if (next_completion == 0 ||
+                    next_expiry - board.cycles < next_completion) {
+                next_completion = next_expiry - board.cycles;
+            }
+        }
+        if (!_replayed_admissions.empty()) {
+            Board::cycles_type next_admission =
+                _replayed_admissions.front().cycle;
+            if (next_admission <= board.cycles) {
+                return 0;
+            }
+            if (next_completion == 0 ||
+                    next_admission - board.cycles < next_completion) {
+                next_completion = next_admission - board.cycles;
+            }
+        }
+        if (_input_readers.empty()) {
+            return next_completion;
+        }
+
+        if (_event_log.IsReplaying()) {
+            Board::cycles_type next_input =
+                board.keyboard.CyclesUntilNextInput();
+            if (next_completion == 0 ||
+                    (next_input != 0 && next_input < next_completion)) {
+                return next_input;
+            }
+            return next_completion;
+        }
+
+        // Host input may arrive at any moment, wait for it a little
+        //   instead of spinning when nothing else is pending
+        if (next_completion == 0) {
+            board.keyboard.WaitForInput();
+        }
+
+        return next_completion;
+    }
+
+    void Kernel::StopAtEvent(
+                     Events event,
+                     Process::process_id_type process_id
+                 )
+    {
+        if ((_stop_events & event) == 0) {
+            return;
+        }
+
+        if (last_events == NoEvents) {
+            last_event_process_id = process_id;
+            board.Stop();
+        }
+        last_events |= event;
+    }
+
+    void Kernel::StopMachine()
+    {
+        _stopped = true;
+        board.Stop();
+    }
+
+    Kernel::Statistics Kernel::GetStatistics() const
+    {
+        Statistics statistics;
+        statistics.page_faults = _page_faults;
+        statistics.compacted_blocks = _compacted_blocks;
+        statistics.compacted_words = _compacted_words;
+        statistics.swapped_out_pages = _swapped_out_pages;
+        statistics.swapped_in_pages = _swapped_in_pages;
+        statistics.suspensions = _suspensions;
+        statistics.realtime_jobs = _realtime_jobs;
+        statistics.deadline_misses = _deadline_misses;
+
+        return statistics;
+    }
+
+    void Kernel::PrintStatistics()
+    {
+        if (board.cycles == 0) {
+            return;
+        }
+
+        double cpu_utilization =
+            100.0 * (board.cycles - board.idle_cycles) / board.cycles;
+        double disk_utilization =
+            100.0 * board.disk.busy_cycles / board.cycles;
+        Statistics statistics = GetStatistics();
+
+        std::cout << "Kernel: " << board.cycles << " cycles, "
+                  << "CPU utilization " << cpu_utilization << "%, "
+                  << "disk utilization " << disk_utilization << "%."
+                  << std::endl;
+        std::cout << "Kernel: " << board.idle_cycles << " idle cycles, "
+                  << board.skipped_cycles << " of them skipped."
+                  << std::endl;
+        std::cout << "Kernel: " << statistics.page_faults << " page faults, "
+                  << board.cpu.invalid_instructions << " invalid instructions."
+                  << std::endl;
+        std::cout << "Kernel: " << statistics.compacted_blocks
+                  << " heap blocks compacted, "
+                  << statistics.compacted_words << " words moved."
+                  << std::endl;
+        std::cout << "Kernel: " << statistics.swapped_out_pages
+                  << " pages swapped out, "
+                  << statistics.swapped_in_pages << " swapped in, "
+                  << statistics.suspensions << " suspensions."
+                  << std::endl;
+        if (board.cpu.cache) {
+            PrintCacheStatistics();
+        }
+        if (statistics.realtime_jobs > 0) {
+            std::cout << "Kernel: " << statistics.realtime_jobs
+                      << " real-time jobs, "
+                      << statistics.deadline_misses << " deadline misses."
+                      << std::endl;
+        }
+    }
+
+    void Kernel::PrintCacheStatistics()
+    {
+        static const char *LEVEL_NAMES[Cache::LEVELS] = { "L1", "L2" };
+
+        for (auto &context : board.cache.GetCounters()) {
+            for (unsigned int level = 0; level < Cache::LEVELS; ++level) {
+                const unsigned long long *results =
+                    context.second.results[level];
+                unsigned long long misses =
+                    results[CacheLevel::CompulsoryMiss] +
+                    results[CacheLevel::CapacityMiss] +
+                    results[CacheLevel::ConflictMiss];
+                if (results[CacheLevel::Hit] + misses == 0) {
+                    continue;
+                }
+
+                std::cout << "Kernel: process " << context.first << " "
+                          << LEVEL_NAMES[level] << " "
+                          << results[CacheLevel::Hit] << " hits, "
+                          << misses << " misses ("
+                          << results[CacheLevel::CompulsoryMiss]
+                          << " compulsory, "
+                          << results[CacheLevel::CapacityMiss]
+                          << " capacity, "
+                          << results[CacheLevel::ConflictMiss]
+                          << " conflict)."
+                          << std::endl;
+            }
+        }
+    }
+
+    void Kernel::SaveCheckpoint()
+    {
+        Checkpoint::Writer writer;
+
+        writer.Write(Checkpoint::MAGIC);
+        writer.Write(Checkpoint::VERSION);
+        writer.Write(static_cast<unsigned long long>(board.memory.ram.size()));
+        writer.Write(static_cast<unsigned long long>(Memory::PAGE_SIZE));
+        writer.Write(static_cast<int>(scheduler));
+
+        // Board and devices
+        writer.Write(board.cycles);
+        writer.Write(board.idle_cycles);
+        writer.Write(board.skipped_cycles);
+        writer.Write(board.cpu.registers);
+        writer.Write(board.cpu.halted);
+        writer.Write(board.cpu.instructions);
+        writer.Write(board.pit.frequency);
+        writer.Write(board.pit.GetPassedCyclesCount());
+        writer.Write(board.disk.latency);
+        writer.Write(board.disk.busy_cycles);
+        writer.Write(board.disk.GetPassedCyclesCount());
+
+        // Kernel and scheduler
+        writer.Write(_last_issued_process_id);
+        writer.Write(_cycles_passed_after_preemption);
+        writer.Write(static_cast<unsigned long long>(_current_process_index));
+        writer.Write(static_cast<unsigned long long>(_last_free_block_index));
+        _timers.Write(writer);
+        writer.Write(_compacting);
+        writer.Write(static_cast<unsigned long long>(_compaction_credit));
+        writer.Write(_compacted_words);
+        writer.Write(_compacted_blocks);
+        writer.Write(_dispatch_cycle);
+        writer.Write(_dispatch_instructions);
+        writer.Write(_last_sample_cycle);
+        writer.Write(_last_control_cycle);
+        writer.Write(_control_faults);
+        writer.Write(_out_of_frames);
+        writer.Write(_swapped_out_pages);
+        writer.Write(_swapped_in_pages);
+        writer.Write(_suspensions);
+        writer.Write(_running_realtime);
+        writer.Write(_realtime_jobs);
+        writer.Write(_deadline_misses);
+        writer.Write(page_table);
+        WriteProcesses(writer, processes);
+        WriteProcesses(writer, blocked);
+        WriteProcesses(writer, suspended);
+        WriteProcesses(writer, realtime);
+        _ipc.Write(writer);
+        _mappings.Write(writer);
+        _message_cache.Write(writer);
+        _page_table_cache.Write(writer);
+        _pcb_cache.Write(writer);
+        writer.Write(static_cast<unsigned long long>(_input_readers.size()));
+        for (auto reader : _input_readers) {
+            writer.Write(reader);
+        }
+
+        // Memory management
+        _swap.Write(writer);
+        writer.Write(static_cast<unsigned long long>(_arrivals.size()));
+        for (auto &arrival : _arrivals) {
+            writer.Write(static_cast<unsigned long long>(arrival.image.size()));
+            writer.WriteBytes(
+                arrival.image.data(),
+                arrival.image.size() * sizeof(int)
+            );
+        }
+        writer.WriteBytes(_frame_ages.data(), _frame_ages.size());
+        writer.WriteBytes(
+            board.memory.referenced.data(),
+            board.memory.referenced.size()
+        );
+
+        // Frame allocator and the frames in use. Free and zero frames are
+        //   not stored
+        auto free_frames = board.memory.GetFreeFrames();
+        writer.Write(static_cast<unsigned long long>(free_frames.size()));
+        for (auto frame : free_frames) {
+            writer.Write(frame);
+        }
+
+        std::vector<bool> is_free(board.memory.ram.size() / Memory::PAGE_SIZE);
+        for (auto frame : free_frames) {
+            is_free[frame] = true;
+        }
+        for (Memory::page_entry_type frame = 0; frame < is_free.size(); ++frame) {
+            if (is_free[frame]) {
+                continue;
+            }
+
+            auto first = board.memory.ram.begin() + frame * Memory::PAGE_SIZE;
+            auto last = first + Memory::PAGE_SIZE;
+            if (std::find_if(first, last, [](int word) { return word != 0; })
+                    == last) {
+                continue;
+            }
+
+            writer.Write(frame);
+            writer.WriteBytes(&*first, Memory::PAGE_SIZE * sizeof(int));
+        }
+        writer.Write(static_cast<Memory::page_entry_type>(Memory::INVALID_PAGE));
+
+        // Only one write is in flight, a slow disk delays the next
+        //   checkpoint instead of piling up
+        if (_checkpoint_writer.joinable()) {
+            _checkpoint_writer.join();
+        }
+        _checkpoint_writer = std::thread(
+            [](std::string path, Checkpoint::buffer_type buffer) {
+                if (!Checkpoint::Save(path, buffer)) {
+                    std::cerr << "Kernel: failed to write the checkpoint."
+                              << std::endl;
+                }
+            },
+            _checkpoint_path,
+            std::move(writer.buffer)
+        );
+    }
+
+    bool Kernel::RestoreCheckpoint(const std::string &path)
+    {
+        Checkpoint::Reader reader;
+        if (!reader.Open(path)) {
+            return false;
+        }
+
+        unsigned int magic, version;
+        unsigned long long ram_size, page_size;
+        int checkpoint_scheduler;
+        if (!reader.Read(magic) || magic != Checkpoint::MAGIC ||
+                !reader.Read(version) || version != Checkpoint::VERSION ||
+                !reader.Read(ram_size) || ram_size != board.memory.ram.size() ||
+                !reader.Read(page_size) || page_size != Memory::PAGE_SIZE ||
+                !reader.Read(checkpoint_scheduler)) {
+            std::cerr << "Kernel: incompatible checkpoint." << std::endl;
+            return false;
+        }
+        if (checkpoint_scheduler != static_cast<int>(scheduler)) {
+            std::cerr << "Kernel: the checkpoint was taken with another "
+                      << "scheduler." << std::endl;
+            return false;
+        }
+
+        // Everything is read into scratch state first, the machine only
+        //   changes once the whole image was read
+        Board::cycles_type cycles, idle_cycles, skipped_cycles;
+        Registers registers;
+        bool halted;
+        unsigned long long instructions;
+        PIT::frequency_type pit_frequency, pit_passed_cycles_count;
+        Disk::cycles_type disk_latency, disk_busy_cycles,
+                          disk_passed_cycles_count;
+
+        Process::process_id_type last_issued_process_id;
+        unsigned int cycles_passed_after_preemption;
+        unsigned long long current_process_index, last_free_block_index;
+        bool compacting;
+        unsigned long long compaction_credit, compacted_words, compacted_blocks;
+        Board::cycles_type dispatch_cycle, last_sample_cycle, last_control_cycle;
+        unsigned long long dispatch_instructions, control_faults;
+        bool out_of_frames;
+        unsigned long long swapped_out_pages, swapped_in_pages, suspensions;
+        bool running_realtime;
+        unsigned long long realtime_jobs, deadline_misses;
+
+        Memory::page_table_type kernel_page_table;
+        TimerWheel timers(_timers);
+        process_list_type restored_processes, restored_blocked, restored_suspended,
+                          restored_realtime;
+        IPC ipc;
+        std::vector<FileMappings::Mapping> mappings;
+        SlabCache message_cache(_message_cache);
+        SlabCache page_table_cache(_page_table_cache);
+        SlabCache pcb_cache(_pcb_cache);
+        std::deque<Process::process_id_type> input_readers;
+        SwapSpace swap;
+        arrival_list_type arrivals;
+        std::vector<unsigned char> frame_ages(_frame_ages.size());
+        std::vector<unsigned char> referenced(board.memory.referenced.size());
+        std::vector<Memory::page_entry_type> free_frames;
+        Memory::ram_type ram(board.memory.ram.size(), 0);
+
+        if (!reader.Read(cycles) ||
+                !reader.Read(idle_cycles) ||
+                !reader.Read(skipped_cycles) ||
+                !reader.Read(registers) ||
+                !reader.Read(halted) ||
+                !reader.Read(instructions) ||
+                !reader.Read(pit_frequency) ||
+                !reader.Read(pit_passed_cycles_count) ||
+                !reader.Read(disk_latency) ||
+                !reader.Read(disk_busy_cycles) ||
+                !reader.Read(disk_passed_cycles_count) ||
+                !reader.Read(last_issued_process_id) ||
+                !reader.Read(cycles_passed_after_preemption) ||
+                !reader.Read(current_process_index) ||
+                !reader.Read(last_free_block_index) ||
+                !timers.Read(reader) ||
+                !reader.Read(compacting) ||
+                !reader.Read(compaction_credit) ||
+                !reader.Read(compacted_words) ||
+                !reader.Read(compacted_blocks) ||
+                !reader.Read(dispatch_cycle) ||
+                !reader.Read(dispatch_instructions) ||
+                !reader.Read(last_sample_cycle) ||
+                !reader.Read(last_control_cycle) ||
+                !reader.Read(control_faults) ||
+                !reader.Read(out_of_frames) ||
+                !reader.Read(swapped_out_pages) ||
+                !reader.Read(swapped_in_pages) ||
+                !reader.Read(suspensions) ||
+                !reader.Read(running_realtime) ||
+                !reader.Read(realtime_jobs) ||
+                !reader.Read(deadline_misses) ||
+                !ReadPageTable(reader, kernel_page_table) ||
+                !ReadProcesses(reader, restored_processes) ||
+                !ReadProcesses(reader, restored_blocked) ||
+                !ReadProcesses(reader, restored_suspended) ||
+                !ReadProcesses(reader, restored_realtime) ||
+                !ipc.Read(reader, ram.size() / Memory::PAGE_SIZE) ||
+                !_mappings.Read(reader, mappings) ||
+                !message_cache.Read(reader) ||
+                !page_table_cache.Read(reader) ||
+                !pcb_cache.Read(reader) ||
+                !ReadInputReaders(reader, input_readers) ||
+                !swap.Read(reader) ||
+                !ReadArrivals(reader, arrivals) ||
+                !reader.ReadBytes(frame_ages.data(), frame_ages.size()) ||
+                !reader.ReadBytes(referenced.data(), referenced.size()) ||
+                !ReadFreeFrames(reader, free_frames) ||
+                !ReadFrames(reader, ram)) {
+            std::cerr << "Kernel: truncated checkpoint." << std::endl;
+            return false;
+        }
+
+        // Board and devices
+        board.cycles = cycles;
+        board.idle_cycles = idle_cycles;
+        board.skipped_cycles = skipped_cycles;
+        board.cpu.registers = registers;
+        board.cpu.halted = halted;
+        board.cpu.instructions = instructions;
+        board.pit.frequency = pit_frequency;
+        board.pit.SetPassedCyclesCount(pit_passed_cycles_count);
+        board.disk.latency = disk_latency;
+        board.disk.busy_cycles = disk_busy_cycles;
+        board.disk.SetPassedCyclesCount(disk_passed_cycles_count);
+
+        // Kernel and scheduler
+        _last_issued_process_id = last_issued_process_id;
+        _cycles_passed_after_preemption = cycles_passed_after_preemption;
+        _current_process_index = current_process_index;
+        _last_free_block_index = last_free_block_index;
+        _compacting = compacting;
+        _compaction_credit = compaction_credit;
+        _compacted_words = compacted_words;
+        _compacted_blocks = compacted_blocks;
+        _dispatch_cycle = dispatch_cycle;
+        _dispatch_instructions = dispatch_instructions;
+        _last_sample_cycle = last_sample_cycle;
+        _last_control_cycle = last_control_cycle;
+        _control_faults = control_faults;
+        _out_of_frames = out_of_frames;
+        _swapped_out_pages = swapped_out_pages;
+        _swapped_in_pages = swapped_in_pages;
+        _suspensions = suspensions;
+        _running_realtime = running_realtime;
+        _realtime_jobs = realtime_jobs;
+        _deadline_misses = deadline_misses;
+        page_table = kernel_page_table;
+        _timers = timers;
+        processes.swap(restored_processes);
+        blocked.swap(restored_blocked);
+        suspended.swap(restored_suspended);
+        realtime.swap(restored_realtime);
+        _ipc = ipc;
+        _mappings.mappings.swap(mappings);
+        _message_cache = message_cache;
+        _page_table_cache = page_table_cache;
+        _pcb_cache = pcb_cache;
+        _input_readers.swap(input_readers);
+
+        // Memory management
+        _swap = swap;
+        _arrivals.swap(arrivals);
+        _frame_ages = frame_ages;
+        board.memory.referenced = referenced;
+        board.memory.SetFreeFrames(free_frames);
+        board.memory.ram = ram;
+
+        bool running =
+            !board.cpu.halted &&
+            (_running_realtime ? !realtime.empty() : !processes.empty());
+        board.memory.page_table =
+            running ? CurrentProcess().page_table : page_table;
+
+        // Verification is not saved, the text is checked again in case the
+        //   checkpoint comes from a build that verifies differently
+        for (auto process_list :
+                 { &processes, &blocked, &suspended, &realtime }) {
+            for (auto &process : *process_list) {
+                process.verified =
+                    _verify &&
+                    process.memory_end_position <= ram.size() &&
+                    process.memory_start_position <= process.memory_end_position &&
+                    Verifier::Verify(
+                        &ram[process.memory_start_position],
+                        process.memory_end_position -
+                            process.memory_start_position,
+                        Memory::PAGE_TABLE_SIZE,
+                        _syscalls
+                    ).verified;
+            }
+        }
+        board.cpu.verified = running && CurrentProcess().verified;
+
+        return true;
+    }
+
+    bool Kernel::ReadPageTable(
+                     Checkpoint::Reader &reader,
+                     Memory::page_table_type &page_table
+                 )
+    {
+        // The entries are in the heap, which comes back with the frames
+        return reader.Read(page_table) &&
+                   page_table <= _KERNEL_MEMORY_SIZE - Memory::PAGE_TABLE_SIZE;
+    }
+
+    void Kernel::WriteProcesses(
+                     Checkpoint::Writer &writer,
+                     const process_list_type &process_list
+                 )
+    {
+        writer.Write(static_cast<unsigned long long>(process_list.size()));
+        for (auto &process : process_list) {
+            writer.Write(process.id);
+            writer.Write(process.pcb);
+            writer.Write(static_cast<int>(process.state));
+            writer.Write(process.priority);
+            writer.Write(process.memory_start_position);
+            writer.Write(process.memory_end_position);
+            writer.Write(process.sequential_instruction_count);
+            writer.Write(process.page_table);
+
+            writer.Write(static_cast<unsigned long long>(process.allotment));
+            writer.Write(process.run_cycles);
+            writer.Write(process.fault_time);
+            writer.Write(process.instructions);
+            writer.Write(process.page_faults);
+            writer.Write(process.context_switches);
+
+            writer.Write(process.period);
+            writer.Write(process.relative_deadline);
+            writer.Write(process.budget);
+            writer.Write(process.release);
+            writer.Write(process.deadline);
+            writer.Write(process.job_start);
+            writer.Write(process.job_done);
+            writer.Write(process.deadline_misses);
+
+            writer.Write(process.timeout);
+            writer.Write(process.timer);
+        }
+    }
+
+    bool Kernel::ReadFreeFrames(
+                     Checkpoint::Reader &reader,
+                     std::vector<Memory::page_entry_type> &free_frames
+                 )
+    {
+        Memory::page_table_size_type frames_count =
+            board.memory.ram.size() / Memory::PAGE_SIZE;
+
+        unsigned long long free_frames_count;
+        if (!reader.Read(free_frames_count) ||
+                free_frames_count > frames_count) {
+            return false;
+        }
+
+        free_frames.resize(free_frames_count);
+        for (auto &frame : free_frames) {
+            if (!reader.Read(frame) || frame >= frames_count) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Kernel::ReadFrames(Checkpoint::Reader &reader, Memory::ram_type &ram)
+    {
+        for (;;) {
+            Memory::page_entry_type frame;
+            if (!reader.Read(frame)) {
+                return false;
+            }
+            if (frame == Memory::INVALID_PAGE) {
+                break;
+            }
+            if (frame >= ram.size() / Memory::PAGE_SIZE ||
+                    !reader.ReadBytes(
+                        &ram[frame * Memory::PAGE_SIZE],
+                        Memory::PAGE_SIZE * sizeof(int)
+                    )) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Kernel::ReadArrivals(
+                     Checkpoint::Reader &reader,
+                     arrival_list_type &arrivals
+                 )
+    {
+        unsigned long long arrivals_count;
+        if (!reader.Read(arrivals_count)) {
+            return false;
+        }
+
+        arrivals.clear();
+        for (unsigned long long i = 0; i < arrivals_count; ++i) {
+            unsigned long long size;
+            if (!reader.Read(size)) {
+                return false;
+            }
+
+            Arrival arrival;
+            arrival.image.resize(size);
+            if (size > 0 &&
+                    !reader.ReadBytes(
+                         arrival.image.data(),
+                         size * sizeof(int)
+                     )) {
+                return false;
+            }
+            if (!arrival.program.Parse(arrival.image)) {
+                return false;
+            }
+            arrivals.push_back(arrival);
+        }
+
+        return true;
+    }
+
+    bool Kernel::ReadInputReaders(
+                     Checkpoint::Reader &reader,
+                     std::deque<Process::process_id_type> &input_readers
+                 )
+    {
+        unsigned long long readers_count;
+        if (!reader.Read(readers_count)) {
+            return false;
+        }
+
+        input_readers.clear();
+        for (unsigned long long i = 0; i < readers_count; ++i) {
+            Process::process_id_type process_id;
+            if (!reader.Read(process_id)) {
+                return false;
+            }
+            input_readers.push_back(process_id);
+        }
+
+        return true;
+    }
+
+    bool Kernel::ReadProcesses(
+                     Checkpoint::Reader &reader,
+                     process_list_type &process_list
+                 )
+    {
+        unsigned long long processes_count;
+        if (!reader.Read(processes_count)) {
+            return false;
+        }
+
+        for (unsigned long long i = 0; i < processes_count; ++i) {
+            Process process(0, 0, 0);
+            process_list.push_back(process);
+
+            Process &restored_process = process_list.back();
+            int state;
+            if (!reader.Read(restored_process.id) ||
+                    !reader.Read(restored_process.pcb) ||
+                    !reader.Read(state) ||
+                    !reader.Read(restored_process.priority) ||
+                    !reader.Read(restored_process.memory_start_position) ||
+                    !reader.Read(restored_process.memory_end_position) ||
+                    !reader.Read(restored_process.sequential_instruction_count) ||
+                    !ReadPageTable(reader, restored_process.page_table)) {
+                return false;
+            }
+
+            // The record is restored with the kernel memory
+            if (restored_process.pcb >
+                    _KERNEL_MEMORY_SIZE - Process::PCB_RECORD_SIZE) {
+                return false;
+            }
+            restored_process.state = static_cast<Process::States>(state);
+
+            unsigned long long allotment;
+            if (!reader.Read(allotment) ||
+                    !reader.Read(restored_process.run_cycles) ||
+                    !reader.Read(restored_process.fault_time) ||
+                    !reader.Read(restored_process.instructions) ||
+                    !reader.Read(restored_process.page_faults) ||
+                    !reader.Read(restored_process.context_switches) ||
+                    !reader.Read(restored_process.period) ||
+                    !reader.Read(restored_process.relative_deadline) ||
+                    !reader.Read(restored_process.budget) ||
+                    !reader.Read(restored_process.release) ||
+                    !reader.Read(restored_process.deadline) ||
+                    !reader.Read(restored_process.job_start) ||
+                    !reader.Read(restored_process.job_done) ||
+                    !reader.Read(restored_process.deadline_misses) ||
+                    !reader.Read(restored_process.timeout) ||
+                    !reader.Read(restored_process.timer)) {
+                return false;
+            }
+            restored_process.allotment =
+                static_cast<Memory::page_table_size_type>(allotment);
+
+            // The node is restored with the kernel memory
+            if (restored_process.timer != TimerWheel::NO_TIMER &&
+                    restored_process.timer >= _KERNEL_MEMORY_SIZE) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Kernel::InterruptHandler(int)
+    {
+        _interrupted = 1;
+    }
+
+    void Kernel::SampleCurrentProcess()
+    {
+        if (board.cpu.halted) {
+            return;
+        }
+
+        Process &process = CurrentProcess();
+        auto &registers = board.cpu.registers;
+
+        Profiler::Sample &sample = _profiler.NextSample();
+        sample.process_id = process.id;
+        sample.offset = registers.ip - process.memory_start_position;
+        sample.depth = 0;
+
+        // Return addresses on the guest stack, stop at the first unmapped
+        //   page instead of faulting
+        if (registers.sp != 0) {
+            for (unsigned int frame = 0;
+                     frame < _profiler.stack_depth; ++frame) {
+                auto page_index_offset_pair =
+                    board.memory.GetPageIndexAndOffsetForVirtualAddress(
+                        registers.sp + frame
+                    );
+                if (page_index_offset_pair.first >= Memory::PAGE_TABLE_SIZE) {
+                    break;
+                }
+                Memory::page_entry_type page_frame_index =
+                    board.memory.GetPageEntry(
+                        process.page_table,
+                        page_index_offset_pair.first
+                    );
+                if (page_frame_index == Memory::INVALID_PAGE) {
+                    break;
+                }
+
+                sample.stack[sample.depth++] =
+                    board.memory.ram[
+                        page_index_offset_pair.second +
+                            Memory::PAGE_SIZE * page_frame_index
+                    ];
+            }
+        }
+    }
 }
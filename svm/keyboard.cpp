@@ -0,0 +1,229 @@
+#include "keyboard.h"
+
+#include <chrono>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace svm
+{
+    namespace
+    {
+        // How often the reader checks for shutdown and a full ring drains
+        const int POLL_PERIOD_MS = 10;
+
+        const std::chrono::milliseconds IDLE_WAIT(1);
+    }
+
+    Keyboard::Keyboard(PIC &pic, const cycles_type *clock)
+        : _descriptor(-1),
+          _reader(),
+          _open(false),
+          _ring(RING_CAPACITY),
+          _head(0),
+          _tail(0),
+          _ended(false),
+          _stopping(false),
+          _visible_head(0),
+          _visible_end(false),
+          _end_notified(false),
+          _replaying(false),
+          _scheduled(),
+          _scheduled_notified(false),
+          _pic(pic),
+          _clock(clock) { }
+
+    Keyboard::~Keyboard()
+    {
+        if (_reader.joinable()) {
+            _stopping = true;
+            _reader.join();
+        }
+        if (_descriptor > STDIN_FILENO) {
+            close(_descriptor);
+        }
+    }
+
+    bool Keyboard::Open(const std::string &path)
+    {
+        if (_open) {
+            return false;
+        }
+
+        if (path == "-") {
+            _descriptor = STDIN_FILENO;
+        } else {
+            // A FIFO would wait for a writer in `open` otherwise
+            _descriptor = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+            if (_descriptor < 0) {
+                return false;
+            }
+        }
+
+        _open = true;
+        _reader = std::thread(&Keyboard::Work, this);
+
+        return true;
+    }
+
+    bool Keyboard::IsOpen() const
+    {
+        return _open || _replaying;
+    }
+
+    bool Keyboard::TryRead(int &word)
+    {
+        if (_replaying) {
+            if (_scheduled.empty() || _scheduled.front().cycle > *_clock ||
+                    _scheduled.front().words.empty()) {
+                return false;
+            }
+
+            Input &input = _scheduled.front();
+            word = input.words[input.position++];
+            if (input.position == input.words.size()) {
+                _scheduled.pop_front();
+                _scheduled_notified = false;
+            }
+
+            return true;
+        }
+
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _visible_head) {
+            return false;
+        }
+
+        word = _ring[tail & (_ring.size() - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool Keyboard::IsAtEnd() const
+    {
+        if (_replaying) {
+            return !_scheduled.empty() &&
+                   _scheduled.front().words.empty() &&
+                   _scheduled.front().cycle <= *_clock;
+        }
+
+        return _visible_end &&
+               _tail.load(std::memory_order_relaxed) == _visible_head;
+    }
+
+    void Keyboard::Schedule(
+                       cycles_type cycle,
+                       const Memory::ram_type &words
+                   )
+    {
+        Input input;
+        input.cycle = cycle;
+        input.words = words;
+        input.position = 0;
+        _scheduled.push_back(input);
+
+        _replaying = true;
+    }
+
+    Keyboard::cycles_type Keyboard::CyclesUntilNextInput() const
+    {
+        if (_scheduled.empty() || _scheduled_notified) {
+            return 0;
+        }
+
+        // `Tick` runs before the clock advances
+        cycles_type cycle = _scheduled.front().cycle;
+        if (cycle <= *_clock) {
+            return 0;
+        }
+
+        return cycle - *_clock;
+    }
+
+    void Keyboard::WaitForInput() const
+    {
+        if (!_open ||
+                _head.load(std::memory_order_acquire) != _visible_head ||
+                _ended.load(std::memory_order_acquire) != _visible_end) {
+            return;
+        }
+
+        std::this_thread::sleep_for(IDLE_WAIT);
+    }
+
+    void Keyboard::Tick()
+    {
+        if (_replaying) {
+            if (!_scheduled_notified && !_scheduled.empty() &&
+                    _scheduled.front().cycle <= *_clock) {
+                _scheduled_notified = true;
+                _pic.isr_1();
+            }
+            return;
+        }
+
+        if (!_open) {
+            return;
+        }
+
+        // The end is loaded first, the head then has every word pushed
+        //   before it
+        bool ended = _ended.load(std::memory_order_acquire);
+        std::size_t head = _head.load(std::memory_order_acquire);
+        if (head != _visible_head) {
+            _visible_head = head;
+            _pic.isr_1();
+        } else if (ended && !_end_notified) {
+            _visible_end = true;
+            _end_notified = true;
+            _pic.isr_1();
+        }
+    }
+
+    void Keyboard::Work()
+    {
+        char buffer[256];
+
+        while (!_stopping.load(std::memory_order_relaxed)) {
+            pollfd descriptor = { _descriptor, POLLIN, 0 };
+            int ready = poll(&descriptor, 1, POLL_PERIOD_MS);
+            if (ready < 0) {
+                break;
+            }
+            if (ready == 0) {
+                continue;
+            }
+
+            ssize_t count = read(_descriptor, buffer, sizeof(buffer));
+            if (count < 0) {
+                continue;
+            }
+            if (count == 0) {
+                break;
+            }
+
+            for (ssize_t i = 0; i < count; ++i) {
+                std::size_t head = _head.load(std::memory_order_relaxed);
+
+                // The guest reads too slowly, wait for room
+                while (head - _tail.load(std::memory_order_acquire) ==
+                           _ring.size()) {
+                    if (_stopping.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(POLL_PERIOD_MS)
+                    );
+                }
+
+                _ring[head & (_ring.size() - 1)] =
+                    static_cast<unsigned char>(buffer[i]);
+                _head.store(head + 1, std::memory_order_release);
+            }
+        }
+
+        _ended.store(true, std::memory_order_release);
+    }
+}
@@ -1,9 +1,14 @@
 #include "memory.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace svm
 {
     Memory::Memory()
-        : ram(DEFAULT_RAM_SIZE)
+        : ram(DEFAULT_RAM_SIZE),
+          page_table(INVALID_PAGE),
+          referenced(DEFAULT_RAM_SIZE / PAGE_SIZE, 0)
     {
         // initialize data structures for the frame allocator
 		int frames_number = DEFAULT_RAM_SIZE / PAGE_SIZE;
@@ -14,13 +19,61 @@ namespace svm
 
     Memory::~Memory() { }
 
-    Memory::page_table_type* Memory::CreateEmptyPageTable()
+    void Memory::ClearPageTable(page_table_type page_table)
     {
         /*
-              Return a new page table (for kernel or processes)
-              Each entry should be invalid
+              Each entry of a page table (for kernel or processes) should
+              be invalid
         */
-		return new vector<Memory::page_entry_type>(DEFAULT_RAM_SIZE / PAGE_SIZE, -1);
+        std::fill(
+            ram.begin() + page_table,
+            ram.begin() + page_table + PAGE_TABLE_SIZE,
+            static_cast<int>(INVALID_PAGE)
+        );
+    }
+
+    void Memory::MapDirectly(page_table_type page_table)
+    {
+        for (page_table_size_type page = 0; page < PAGE_TABLE_SIZE; ++page) {
+            ram[page_table + page] = static_cast<int>(page);
+        }
+    }
+
+    Memory::page_entry_type Memory::GetPageEntry(
+                                        page_table_type page_table,
+                                        page_table_size_type page
+                                    ) const
+    {
+        if (page >= PAGE_TABLE_SIZE) {
+            throw std::out_of_range("page table");
+        }
+
+        return static_cast<page_entry_type>(ram[page_table + page]);
+    }
+
+    void Memory::SetPageEntry(
+                     page_table_type page_table,
+                     page_table_size_type page,
+                     page_entry_type frame
+                 )
+    {
+        if (page >= PAGE_TABLE_SIZE) {
+            throw std::out_of_range("page table");
+        }
+
+        ram[page_table + page] = static_cast<int>(frame);
+    }
+
+    Memory::page_table_size_type Memory::CountMappedPages(
+                                             page_table_type page_table
+                                         ) const
+    {
+        return PAGE_TABLE_SIZE -
+                   std::count(
+                       ram.begin() + page_table,
+                       ram.begin() + page_table + PAGE_TABLE_SIZE,
+                       static_cast<int>(INVALID_PAGE)
+                   );
     }
 
     Memory::page_index_offset_pair_type
@@ -56,4 +109,46 @@ namespace svm
         //free the physical frame (you can use a bitmap or stack)
 		frames.push(page);
 	}
+
+    Memory::page_table_size_type Memory::GetFreeFramesCount() const
+    {
+        return frames.size();
+    }
+
+    void Memory::ReserveFrames(page_entry_type first_free_frame)
+    {
+        std::stack<page_entry_type> free_frames;
+        while (!frames.empty()) {
+            if (frames.top() >= first_free_frame) {
+                free_frames.push(frames.top());
+            }
+            frames.pop();
+        }
+        while (!free_frames.empty()) {
+            frames.push(free_frames.top());
+            free_frames.pop();
+        }
+    }
+
+    std::vector<Memory::page_entry_type> Memory::GetFreeFrames() const
+    {
+        std::vector<page_entry_type> free_frames;
+
+        std::stack<page_entry_type> pool(frames);
+        while (!pool.empty()) {
+            free_frames.push_back(pool.top());
+            pool.pop();
+        }
+        std::reverse(free_frames.begin(), free_frames.end());
+
+        return free_frames;
+    }
+
+    void Memory::SetFreeFrames(const std::vector<page_entry_type> &free_frames)
+    {
+        frames = std::stack<page_entry_type>();
+        for (auto frame : free_frames) {
+            frames.push(frame);
+        }
+    }
 }
@@ -6,6 +6,7 @@ namespace svm
         : isr_0([]()  { }),
           isr_1([]()  { }),
           isr_2([]()  { }),
+          syscall([](int) { }),
           isr_3([]()  { }),
           isr_4([]()  { }),
           isr_5([]()  { }),
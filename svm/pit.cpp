@@ -4,7 +4,10 @@ namespace svm
 {
     PIT::PIT(PIC &pic)
         : frequency(DEFAULT_FREQUENCY),
+          sampling_frequency(0),
+          sample([]() { }),
           _passed_cycles_count(0),
+          _passed_sampling_cycles_count(0),
           _pic(pic) { }
 
     PIT::~PIT() { }
@@ -17,5 +20,39 @@ namespace svm
             _pic.isr_0();
             _passed_cycles_count = 0;
         }
+
+        if (sampling_frequency != 0 &&
+                ++_passed_sampling_cycles_count >= sampling_frequency) {
+            sample();
+            _passed_sampling_cycles_count = 0;
+        }
+    }
+
+    PIT::frequency_type PIT::GetPassedCyclesCount() const
+    {
+        return _passed_cycles_count;
+    }
+
+    void PIT::SetPassedCyclesCount(frequency_type passed_cycles_count)
+    {
+        _passed_cycles_count = passed_cycles_count;
+    }
+
+    void PIT::FastForward(unsigned long long cycles)
+    {
+        _passed_cycles_count =
+            static_cast<frequency_type>(
+                (_passed_cycles_count + cycles) % frequency
+            );
+
+        // The profiler keeps its phase, samples of the idle CPU are
+        //   dropped anyway
+        if (sampling_frequency != 0) {
+            _passed_sampling_cycles_count =
+                static_cast<frequency_type>(
+                    (_passed_sampling_cycles_count + cycles) %
+                        sampling_frequency
+                );
+        }
     }
 }
@@ -8,25 +8,71 @@ namespace svm
                  Memory::ram_size_type memory_end_position
              )
         : id(id),
-          registers(),
+          pcb(Memory::INVALID_PAGE),
           state(Ready),
           priority(0),
           memory_start_position(memory_start_position),
           memory_end_position(memory_end_position)
     {
-        registers.ip =
-            memory_start_position;
-
         sequential_instruction_count =
             (memory_end_position - memory_start_position) / 2;
 
-        page_table =
-            Memory::CreateEmptyPageTable();
+        page_table = Memory::INVALID_PAGE;
+
+        verified = false;
+        pending_requests = 0;
+
+        timeout = 0;
+        timer = TimerWheel::NO_TIMER;
+
+        allotment = 0;
+        run_cycles = 0;
+        fault_time = 0;
+
+        instructions = 0;
+        page_faults = 0;
+        context_switches = 0;
+
+        period = 0;
+        relative_deadline = 0;
+        budget = 0;
+        release = 0;
+        deadline = 0;
+        job_start = 0;
+        job_done = true;
+        deadline_misses = 0;
     }
 
-    Process::~Process()
+    Process::~Process() { }
+
+    Registers Process::LoadRegisters(const Memory &memory) const
     {
-        delete page_table;
+        const int *record = &memory.ram[pcb];
+
+        Registers registers;
+        registers.a = record[0];
+        registers.b = record[1];
+        registers.c = record[2];
+        registers.flags = record[3];
+        registers.ip = static_cast<unsigned int>(record[4]);
+        registers.sp = static_cast<unsigned int>(record[5]);
+
+        return registers;
+    }
+
+    void Process::StoreRegisters(
+                      Memory &memory,
+                      const Registers &registers
+                  ) const
+    {
+        int *record = &memory.ram[pcb];
+
+        record[0] = registers.a;
+        record[1] = registers.b;
+        record[2] = registers.c;
+        record[3] = registers.flags;
+        record[4] = static_cast<int>(registers.ip);
+        record[5] = static_cast<int>(registers.sp);
     }
 
     bool Process::operator<(const Process &another_process) const {
@@ -0,0 +1,155 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "cpu.h"
+
+namespace svm
+{
+    Profiler::Profiler()
+        : stack_depth(0),
+          _samples(),
+          _samples_count(0),
+          _enabled(false),
+          _total_samples_count(0),
+          _folded_stacks(),
+          _histogram(),
+          _images() { }
+
+    Profiler::~Profiler() { }
+
+    void Profiler::Start(capacity_type capacity, unsigned int stack_depth)
+    {
+        _samples.resize(capacity > 0 ? capacity : 1);
+        _samples_count = 0;
+
+        this->stack_depth =
+            stack_depth < MAX_STACK_DEPTH ? stack_depth : MAX_STACK_DEPTH;
+
+        _enabled = true;
+    }
+
+    bool Profiler::IsEnabled() const
+    {
+        return _enabled;
+    }
+
+    Profiler::Sample &Profiler::NextSample()
+    {
+        if (_samples_count == _samples.size()) {
+            Drain();
+        }
+
+        return _samples[_samples_count++];
+    }
+
+    void Profiler::AddImage(
+                       process_id_type process_id,
+                       const Memory::ram_type &image
+                   )
+    {
+        _images[process_id] = image;
+    }
+
+    bool Profiler::Save(const std::string &path)
+    {
+        Drain();
+
+        std::ofstream folded_stream(path);
+        for (auto &stack : _folded_stacks) {
+            folded_stream << stack.first << " " << stack.second << "\n";
+        }
+
+        std::vector<
+            std::pair<
+                unsigned long long,
+                std::pair<process_id_type, Memory::ram_size_type>
+            >
+        > hot_ips;
+        for (auto &ip : _histogram) {
+            hot_ips.push_back(std::make_pair(ip.second, ip.first));
+        }
+        std::sort(hot_ips.rbegin(), hot_ips.rend());
+
+        std::ofstream histogram_stream(path + ".ips");
+        histogram_stream << "# samples  percent  process  +offset instruction\n";
+        for (auto &ip : hot_ips) {
+            histogram_stream << std::setw(9) << ip.first << "  "
+                             << std::setw(6) << std::fixed << std::setprecision(2)
+                             << 100.0 * ip.first / _total_samples_count << "%  "
+                             << std::setw(7) << ip.second.first << "  "
+                             << DescribeFrame(ip.second.first, ip.second.second)
+                             << "\n";
+        }
+
+        return folded_stream.good() && histogram_stream.good();
+    }
+
+    void Profiler::Drain()
+    {
+        for (capacity_type i = 0; i < _samples_count; ++i) {
+            const Sample &sample = _samples[i];
+
+            std::ostringstream stack;
+            stack << "process " << sample.process_id;
+            for (unsigned int frame = sample.depth; frame > 0; --frame) {
+                stack << ";"
+                      << DescribeFrame(sample.process_id, sample.stack[frame - 1]);
+            }
+            stack << ";" << DescribeFrame(sample.process_id, sample.offset);
+
+            ++_folded_stacks[stack.str()];
+            ++_histogram[std::make_pair(sample.process_id, sample.offset)];
+        }
+
+        _total_samples_count += _samples_count;
+        _samples_count = 0;
+    }
+
+    std::string Profiler::DescribeFrame(
+                              process_id_type process_id,
+                              Memory::ram_size_type offset
+                          )
+    {
+        std::ostringstream frame;
+        frame << "+" << offset << " ";
+
+        auto image = _images.find(process_id);
+        if (image == _images.end() || offset + 1 >= image->second.size()) {
+            frame << "?";
+            return frame.str();
+        }
+
+        // Annotate with the svmasm statement that produced the words
+        int instruction = image->second[offset];
+        int data = image->second[offset + 1];
+        switch (instruction)
+        {
+            case CPU::MOVA_OPCODE: frame << "mov a " << data; break;
+            case CPU::MOVB_OPCODE: frame << "mov b " << data; break;
+            case CPU::MOVC_OPCODE: frame << "mov c " << data; break;
+            case CPU::JMP_OPCODE:  frame << "jmp " << data;   break;
+            case CPU::INT_OPCODE:  frame << "int " << data;   break;
+            case CPU::LDA_OPCODE:  frame << "ld a " << data;  break;
+            case CPU::LDB_OPCODE:  frame << "ld b " << data;  break;
+            case CPU::LDC_OPCODE:  frame << "ld c " << data;  break;
+            case CPU::STA_OPCODE:  frame << "st a " << data;  break;
+            case CPU::STB_OPCODE:  frame << "st b " << data;  break;
+            case CPU::STC_OPCODE:  frame << "st c " << data;  break;
+            case CPU::CPY_OPCODE:  frame << "cpy";            break;
+            case CPU::FILL_OPCODE: frame << "fill";           break;
+            case CPU::CMP_OPCODE:  frame << "cmp";            break;
+            case CPU::RDCYCLEA_OPCODE: frame << "rdcycle a"; break;
+            case CPU::RDCYCLEB_OPCODE: frame << "rdcycle b"; break;
+            case CPU::RDCYCLEC_OPCODE: frame << "rdcycle c"; break;
+            default:
+                frame << ".word " << instruction << " " << data;
+                break;
+        }
+
+        return frame.str();
+    }
+}
@@ -0,0 +1,220 @@
+#include "slab.h"
+
+namespace svm
+{
+    namespace
+    {
+        // Slab header fields
+        const Memory::ram_size_type NEXT_SLAB     = 0;
+        const Memory::ram_size_type PREVIOUS_SLAB = 1;
+        const Memory::ram_size_type FREE_COUNT    = 2;
+        const Memory::ram_size_type FIRST_FREE    = 3;
+
+        // Words before an object
+        const Memory::ram_size_type OBJECT_SLAB        = 2;
+        const Memory::ram_size_type OBJECT_NEXT_FREE   = 1;
+        const Memory::ram_size_type OBJECT_HEADER_SIZE = 2;
+    }
+
+    SlabCache::SlabCache(
+                   Memory &memory,
+                   Memory::ram_size_type object_size,
+                   allocate_type allocate,
+                   free_type free,
+                   constructor_type constructor
+               )
+        : _memory(memory),
+          _object_size(object_size > 0 ? object_size : 1),
+          _slab_size(Memory::PAGE_SIZE),
+          _objects_per_slab(0),
+          _allocate(allocate),
+          _free(free),
+          _constructor(constructor),
+          _partial_slabs(NO_OBJECT),
+          _slabs_count(0),
+          _allocated_objects_count(0)
+    {
+        while (_slab_size - SLAB_HEADER_SIZE <
+                   _object_size + OBJECT_HEADER_SIZE) {
+            _slab_size += Memory::PAGE_SIZE;
+        }
+        _objects_per_slab =
+            (_slab_size - SLAB_HEADER_SIZE) /
+                (_object_size + OBJECT_HEADER_SIZE);
+    }
+
+    Memory::ram_size_type SlabCache::Allocate()
+    {
+        if (_partial_slabs == NO_OBJECT && !Grow()) {
+            return NO_OBJECT;
+        }
+
+        auto &ram = _memory.ram;
+        Memory::ram_size_type slab = _partial_slabs;
+
+        Memory::ram_size_type object = ram[slab + FIRST_FREE];
+        ram[slab + FIRST_FREE] = ram[object - OBJECT_NEXT_FREE];
+        if (--ram[slab + FREE_COUNT] == 0) {
+            Unlink(slab);
+        }
+
+        ++_allocated_objects_count;
+
+        return object;
+    }
+
+    void SlabCache::Free(Memory::ram_size_type object)
+    {
+        auto &ram = _memory.ram;
+        Memory::ram_size_type slab = ram[object - OBJECT_SLAB];
+
+        ram[object - OBJECT_NEXT_FREE] = ram[slab + FIRST_FREE];
+        ram[slab + FIRST_FREE] = object;
+        if (++ram[slab + FREE_COUNT] == 1) {
+            Link(slab);
+        }
+
+        --_allocated_objects_count;
+
+        // Keep one empty slab to avoid growing and shrinking on every
+        //   allocation
+        if (static_cast<Memory::ram_size_type>(ram[slab + FREE_COUNT]) ==
+                    _objects_per_slab &&
+                _slabs_count > 1) {
+            Unlink(slab);
+            _free(slab);
+            --_slabs_count;
+        }
+    }
+
+    Memory::ram_size_type SlabCache::GetObjectSize() const
+    {
+        return _object_size;
+    }
+
+    Memory::ram_size_type SlabCache::GetSlabSize() const
+    {
+        return _slab_size;
+    }
+
+    Memory::ram_size_type SlabCache::GetObjectsPerSlab() const
+    {
+        return _objects_per_slab;
+    }
+
+    Memory::ram_size_type SlabCache::GetSlabsCount() const
+    {
+        return _slabs_count;
+    }
+
+    Memory::ram_size_type SlabCache::GetAllocatedObjectsCount() const
+    {
+        return _allocated_objects_count;
+    }
+
+    void SlabCache::Write(Checkpoint::Writer &writer) const
+    {
+        writer.Write(_partial_slabs);
+        writer.Write(_slabs_count);
+        writer.Write(_allocated_objects_count);
+    }
+
+    bool SlabCache::Read(Checkpoint::Reader &reader)
+    {
+        return reader.Read(_partial_slabs) &&
+               reader.Read(_slabs_count) &&
+               reader.Read(_allocated_objects_count);
+    }
+
+    SlabCache::SlabCache(const SlabCache &other)
+        : _memory(other._memory),
+          _object_size(other._object_size),
+          _slab_size(other._slab_size),
+          _objects_per_slab(other._objects_per_slab),
+          _allocate(other._allocate),
+          _free(other._free),
+          _constructor(other._constructor),
+          _partial_slabs(other._partial_slabs),
+          _slabs_count(other._slabs_count),
+          _allocated_objects_count(other._allocated_objects_count) { }
+
+    SlabCache &SlabCache::operator=(const SlabCache &other)
+    {
+        _object_size = other._object_size;
+        _slab_size = other._slab_size;
+        _objects_per_slab = other._objects_per_slab;
+        _allocate = other._allocate;
+        _free = other._free;
+        _constructor = other._constructor;
+        _partial_slabs = other._partial_slabs;
+        _slabs_count = other._slabs_count;
+        _allocated_objects_count = other._allocated_objects_count;
+
+        return *this;
+    }
+
+    bool SlabCache::Grow()
+    {
+        if (_objects_per_slab == 0) {
+            return false;
+        }
+
+        Memory::ram_size_type slab = _allocate(_slab_size);
+        if (slab == NO_OBJECT) {
+            return false;
+        }
+
+        auto &ram = _memory.ram;
+
+        // Objects are linked in address order
+        Memory::ram_size_type next = NO_OBJECT;
+        for (Memory::ram_size_type i = _objects_per_slab; i-- > 0; ) {
+            Memory::ram_size_type object =
+                slab + SLAB_HEADER_SIZE +
+                    i * (_object_size + OBJECT_HEADER_SIZE) +
+                    OBJECT_HEADER_SIZE;
+            ram[object - OBJECT_SLAB] = slab;
+            ram[object - OBJECT_NEXT_FREE] = next;
+            if (_constructor) {
+                _constructor(object);
+            }
+            next = object;
+        }
+
+        ram[slab + FREE_COUNT] = _objects_per_slab;
+        ram[slab + FIRST_FREE] = next;
+        Link(slab);
+
+        ++_slabs_count;
+
+        return true;
+    }
+
+    void SlabCache::Link(Memory::ram_size_type slab)
+    {
+        auto &ram = _memory.ram;
+
+        ram[slab + NEXT_SLAB] = _partial_slabs;
+        ram[slab + PREVIOUS_SLAB] = static_cast<int>(NO_OBJECT);
+        if (_partial_slabs != NO_OBJECT) {
+            ram[_partial_slabs + PREVIOUS_SLAB] = slab;
+        }
+        _partial_slabs = slab;
+    }
+
+    void SlabCache::Unlink(Memory::ram_size_type slab)
+    {
+        auto &ram = _memory.ram;
+
+        Memory::ram_size_type next = ram[slab + NEXT_SLAB];
+        Memory::ram_size_type previous = ram[slab + PREVIOUS_SLAB];
+        if (previous != NO_OBJECT) {
+            ram[previous + NEXT_SLAB] = next;
+        } else {
+            _partial_slabs = next;
+        }
+        if (next != NO_OBJECT) {
+            ram[next + PREVIOUS_SLAB] = previous;
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <cstdlib>
 
 #include "kernel.h"
 
@@ -80,8 +81,92 @@ int main(int argc, char *argv[])
                 Kernel::Undefined;
         }
 
+        Kernel::Options options;
+
         std::vector<Memory::ram_type> processes;
         for (int i = 2; i < argc; ++i) {
+            std::string argument(argv[i]);
+            if (argument.compare(0, 6, "/disk:") == 0) {
+                options.disk_image_path =
+                    argument.substr(6);
+                continue;
+            } else if (argument.compare(0, 21, "/checkpoint-interval:") == 0) {
+                options.checkpoint_interval =
+                    std::strtoull(argument.c_str() + 21, NULL, 10);
+                continue;
+            } else if (argument.compare(0, 12, "/checkpoint:") == 0) {
+                options.checkpoint_path =
+                    argument.substr(12);
+                continue;
+            } else if (argument.compare(0, 9, "/restore:") == 0) {
+                options.restore_path =
+                    argument.substr(9);
+                continue;
+            } else if (argument.compare(0, 18, "/profile-interval:") == 0) {
+                options.profile_interval =
+                    std::strtoul(argument.c_str() + 18, NULL, 10);
+                continue;
+            } else if (argument.compare(0, 15, "/profile-stack:") == 0) {
+                options.profile_stack_depth =
+                    std::strtoul(argument.c_str() + 15, NULL, 10);
+                continue;
+            } else if (argument.compare(0, 9, "/profile:") == 0) {
+                options.profile_path =
+                    argument.substr(9);
+                continue;
+            } else if (argument.compare(0, 8, "/record:") == 0) {
+                options.record_path =
+                    argument.substr(8);
+                continue;
+            } else if (argument.compare(0, 13, "/trace-level:") == 0) {
+                std::string level = argument.substr(13);
+                options.trace_level =
+                    level == "error" ? Trace::Errors :
+                        level == "debug" ? Trace::Debug : Trace::Info;
+                continue;
+            } else if (argument.compare(0, 7, "/trace:") == 0) {
+                options.trace_path =
+                    argument.substr(7);
+                continue;
+            } else if (argument.compare(0, 7, "/input:") == 0) {
+                options.input_path =
+                    argument.substr(7);
+                continue;
+            } else if (argument.compare(0, 5, "/map:") == 0) {
+                options.mapped_file_paths.push_back(
+                    argument.substr(5)
+                );
+                continue;
+            } else if (argument.compare(0, 10, "/cache-l1:") == 0 ||
+                           argument.compare(0, 10, "/cache-l2:") == 0) {
+                unsigned int level = argument[8] == '1' ? 0 : 1;
+                if (!CacheLevel::Config::Parse(
+                         argument.substr(10),
+                         options.cache.levels[level]
+                     )) {
+                    std::cerr << "SVM: invalid cache geometry, the level "
+                              << "is off." << std::endl;
+                    options.cache.levels[level] = CacheLevel::Config();
+                }
+                continue;
+            } else if (argument.compare(0, 15, "/cache-penalty:") == 0) {
+                char *end;
+                options.cache.miss_penalties[0] =
+                    std::strtoul(argument.c_str() + 15, &end, 10);
+                if (*end == ',') {
+                    options.cache.miss_penalties[1] =
+                        std::strtoul(end + 1, NULL, 10);
+                }
+                continue;
+            } else if (argument == "/verify:off") {
+                options.verify = false;
+                continue;
+            } else if (argument.compare(0, 8, "/replay:") == 0) {
+                options.replay_path =
+                    argument.substr(8);
+                continue;
+            }
+
             Memory::ram_type *executable = LoadExecutable(argv[i]);
             if (executable) {
                 processes.push_back(*executable);
@@ -92,11 +177,13 @@ int main(int argc, char *argv[])
         if (scheduler == Kernel::Undefined) {
             std::cerr << "SVM: invalid scheduler selection. Exiting..."
                       << std::endl;
-        } else if (processes.empty()) {
+        } else if (processes.empty() && options.restore_path.empty() &&
+                       options.replay_path.empty()) {
             std::cerr << "SVM: nothing to run. Exiting..."
                       << std::endl;
         } else {
-            Kernel kernel(scheduler, processes);
+            Kernel kernel(scheduler, processes, options);
+            kernel.Run();
         }
     }
 
@@ -0,0 +1,110 @@
+#include "swap_space.h"
+
+#include <algorithm>
+
+namespace svm
+{
+    SwapSpace::SwapSpace()
+        : _pages() { }
+
+    void SwapSpace::Store(
+                        Process::process_id_type process_id,
+                        Memory::page_table_size_type page,
+                        const int *words
+                    )
+    {
+        key_type key(process_id, page);
+        if (std::find_if(
+                words,
+                words + Memory::PAGE_SIZE,
+                [](int word) { return word != 0; }
+            ) == words + Memory::PAGE_SIZE) {
+            _pages.erase(key);
+            return;
+        }
+
+        _pages[key].assign(words, words + Memory::PAGE_SIZE);
+    }
+
+    bool SwapSpace::Load(
+                        Process::process_id_type process_id,
+                        Memory::page_table_size_type page,
+                        int *words
+                    )
+    {
+        auto stored_page = _pages.find(key_type(process_id, page));
+        if (stored_page == _pages.end()) {
+            return false;
+        }
+
+        std::copy(stored_page->second.begin(), stored_page->second.end(), words);
+        _pages.erase(stored_page);
+
+        return true;
+    }
+
+    void SwapSpace::Discard(
+                        Process::process_id_type process_id,
+                        Memory::page_table_size_type page
+                    )
+    {
+        _pages.erase(key_type(process_id, page));
+    }
+
+    void SwapSpace::Discard(Process::process_id_type process_id)
+    {
+        _pages.erase(
+            _pages.lower_bound(key_type(process_id, 0)),
+            _pages.lower_bound(key_type(process_id + 1, 0))
+        );
+    }
+
+    std::size_t SwapSpace::GetPagesCount() const
+    {
+        return _pages.size();
+    }
+
+    void SwapSpace::Write(Checkpoint::Writer &writer) const
+    {
+        writer.Write(static_cast<unsigned long long>(_pages.size()));
+        for (auto &page : _pages) {
+            writer.Write(page.first.first);
+            writer.Write(static_cast<unsigned long long>(page.first.second));
+            writer.WriteBytes(
+                &page.second[0],
+                Memory::PAGE_SIZE * sizeof(int)
+            );
+        }
+    }
+
+    bool SwapSpace::Read(Checkpoint::Reader &reader)
+    {
+        _pages.clear();
+
+        unsigned long long pages_count;
+        if (!reader.Read(pages_count)) {
+            return false;
+        }
+        for (unsigned long long i = 0; i < pages_count; ++i) {
+            Process::process_id_type process_id;
+            unsigned long long page;
+            if (!reader.Read(process_id) || !reader.Read(page)) {
+                return false;
+            }
+
+            Memory::ram_type &words =
+                _pages[
+                    key_type(
+                        process_id,
+                        static_cast<Memory::page_table_size_type>(page)
+                    )
+                ];
+            words.resize(Memory::PAGE_SIZE);
+            if (!reader.ReadBytes(&words[0], Memory::PAGE_SIZE * sizeof(int))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
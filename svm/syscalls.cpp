@@ -0,0 +1,51 @@
+#include "syscalls.h"
+
+namespace svm
+{
+    SyscallTable::Entry::Entry()
+        : handler(),
+          batchable(false) { }
+
+    SyscallTable::SyscallTable()
+        : _entries() { }
+
+    void SyscallTable::Register(
+                           int number,
+                           handler_type handler,
+                           bool batchable
+                       )
+    {
+        if (number < 0) {
+            return;
+        }
+
+        if (static_cast<std::size_t>(number) >= _entries.size()) {
+            _entries.resize(number + 1);
+        }
+        _entries[number].handler = handler;
+        _entries[number].batchable = batchable;
+    }
+
+    bool SyscallTable::IsRegistered(int number) const
+    {
+        return number >= 0 &&
+               static_cast<std::size_t>(number) < _entries.size() &&
+               _entries[number].handler;
+    }
+
+    bool SyscallTable::IsBatchable(int number) const
+    {
+        return IsRegistered(number) && _entries[number].batchable;
+    }
+
+    bool SyscallTable::Dispatch(int number) const
+    {
+        if (!IsRegistered(number)) {
+            return false;
+        }
+
+        _entries[number].handler();
+
+        return true;
+    }
+}
@@ -0,0 +1,327 @@
+#include "timer_wheel.h"
+
+namespace svm
+{
+    namespace
+    {
+        // Node words, the expiry is split in two
+        const std::size_t EXPIRY_LOW  = 0;
+        const std::size_t EXPIRY_HIGH = 1;
+        const std::size_t OWNER       = 2;
+        const std::size_t KIND        = 3;
+        const std::size_t PREVIOUS    = 4;
+        const std::size_t NEXT        = 5;
+        const std::size_t SLOT        = 6; // Index in `_slots`, NO_TIMER if
+                                           //   free
+        const std::size_t NODE_SIZE   = 7;
+    }
+
+    TimerWheel::TimerWheel(
+                    Memory &memory,
+                    SlabCache::allocate_type allocate,
+                    SlabCache::free_type free
+                )
+        : _memory(memory),
+          _nodes(
+              memory,
+              NODE_SIZE,
+              allocate,
+              free,
+              [&memory](Memory::ram_size_type node) {
+                  memory.ram[node + SLOT] = static_cast<int>(NO_TIMER);
+              }
+          ),
+          _slots(LEVELS * SLOTS, static_cast<timer_id_type>(NO_TIMER)),
+          _count(0),
+          _current(0)
+    {
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            _level_counts[level] = 0;
+        }
+    }
+
+    TimerWheel::timer_id_type TimerWheel::Add(
+                                              cycles_type expiry,
+                                              unsigned int owner,
+                                              int kind
+                                          )
+    {
+        timer_id_type timer = _nodes.Allocate();
+        if (timer == SlabCache::NO_OBJECT) {
+            return NO_TIMER;
+        }
+
+        auto &ram = _memory.ram;
+        if (expiry <= _current) {
+            expiry = _current + 1;
+        }
+        ram[timer + EXPIRY_LOW] = static_cast<int>(expiry & 0xFFFFFFFF);
+        ram[timer + EXPIRY_HIGH] = static_cast<int>(expiry >> 32);
+        ram[timer + OWNER] = static_cast<int>(owner);
+        ram[timer + KIND] = kind;
+
+        Link(timer);
+        ++_count;
+
+        return timer;
+    }
+
+    void TimerWheel::Cancel(timer_id_type timer)
+    {
+        if (timer > _memory.ram.size() - NODE_SIZE ||
+                GetField(timer, SLOT) == NO_TIMER) {
+            return;
+        }
+
+        Unlink(timer);
+        --_count;
+
+        // Given back in the constructed state
+        SetField(timer, SLOT, NO_TIMER);
+        _nodes.Free(timer);
+    }
+
+    void TimerWheel::Advance(cycles_type now, std::vector<Expired> &expired)
+    {
+        while (_current < now) {
+            if (_count == 0) {
+                _current = now;
+                break;
+            }
+
+            // Jump to the next turn over of the lowest level with timers,
+            //   nothing expires or moves before it
+            unsigned int level = 0;
+            while (_level_counts[level] == 0) {
+                ++level;
+            }
+            if (level > 0) {
+                unsigned int shift = level * SLOT_BITS;
+                cycles_type turn = ((_current >> shift) + 1) << shift;
+                if (turn > now) {
+                    _current = now;
+                    break;
+                }
+                _current = turn - 1;
+            }
+
+            cycles_type tick = ++_current;
+
+            // Higher levels first, their timers may be due at this tick
+            for (unsigned int higher = 1; higher < LEVELS; ++higher) {
+                unsigned int shift = higher * SLOT_BITS;
+                if ((tick & ((static_cast<cycles_type>(1) << shift) - 1)) != 0) {
+                    break;
+                }
+                Cascade(higher, (tick >> shift) & (SLOTS - 1));
+            }
+
+            std::size_t slot = tick & (SLOTS - 1);
+            while (_slots[slot] != NO_TIMER) {
+                timer_id_type timer = _slots[slot];
+
+                Expired entry;
+                entry.owner = static_cast<unsigned int>(GetField(timer, OWNER));
+                entry.kind = static_cast<int>(GetField(timer, KIND));
+                expired.push_back(entry);
+
+                Cancel(timer);
+            }
+        }
+    }
+
+    TimerWheel::cycles_type TimerWheel::CyclesUntilNextExpiry() const
+    {
+        if (_count == 0) {
+            return 0;
+        }
+
+        if (_level_counts[0] > 0) {
+            for (cycles_type tick = _current + 1; ; ++tick) {
+                if (_slots[tick & (SLOTS - 1)] != NO_TIMER) {
+                    return tick - _current;
+                }
+            }
+        }
+
+        unsigned int level = 1;
+        while (_level_counts[level] == 0) {
+            ++level;
+        }
+        unsigned int shift = level * SLOT_BITS;
+
+        return (((_current >> shift) + 1) << shift) - _current;
+    }
+
+    std::size_t TimerWheel::GetCount() const
+    {
+        return _count;
+    }
+
+    TimerWheel::cycles_type TimerWheel::GetCurrentCycle() const
+    {
+        return _current;
+    }
+
+    void TimerWheel::Write(Checkpoint::Writer &writer) const
+    {
+        writer.Write(_current);
+        writer.Write(_count);
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            writer.Write(_level_counts[level]);
+        }
+        for (auto head : _slots) {
+            writer.Write(head);
+        }
+        _nodes.Write(writer);
+    }
+
+    bool TimerWheel::Read(Checkpoint::Reader &reader)
+    {
+        if (!reader.Read(_current) || !reader.Read(_count)) {
+            return false;
+        }
+
+        std::size_t count = 0;
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            if (!reader.Read(_level_counts[level])) {
+                return false;
+            }
+            count += _level_counts[level];
+        }
+        if (count != _count) {
+            return false;
+        }
+
+        for (auto &head : _slots) {
+            if (!reader.Read(head) ||
+                    (head != NO_TIMER &&
+                         head > _memory.ram.size() - NODE_SIZE)) {
+                return false;
+            }
+        }
+
+        return _nodes.Read(reader);
+    }
+
+    TimerWheel::TimerWheel(const TimerWheel &other)
+        : _memory(other._memory),
+          _nodes(other._nodes),
+          _slots(other._slots),
+          _count(other._count),
+          _current(other._current)
+    {
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            _level_counts[level] = other._level_counts[level];
+        }
+    }
+
+    TimerWheel &TimerWheel::operator=(const TimerWheel &other)
+    {
+        _nodes = other._nodes;
+        _slots = other._slots;
+        for (unsigned int level = 0; level < LEVELS; ++level) {
+            _level_counts[level] = other._level_counts[level];
+        }
+        _count = other._count;
+        _current = other._current;
+
+        return *this;
+    }
+
+    TimerWheel::cycles_type TimerWheel::GetExpiry(timer_id_type timer) const
+    {
+        auto &ram = _memory.ram;
+
+        return
+            static_cast<cycles_type>(
+                static_cast<unsigned int>(ram[timer + EXPIRY_HIGH])
+            ) << 32 |
+            static_cast<unsigned int>(ram[timer + EXPIRY_LOW]);
+    }
+
+    TimerWheel::timer_id_type TimerWheel::GetField(
+                                              timer_id_type timer,
+                                              std::size_t field
+                                          ) const
+    {
+        // -1 words come back as NO_TIMER
+        return static_cast<timer_id_type>(_memory.ram[timer + field]);
+    }
+
+    void TimerWheel::SetField(
+                         timer_id_type timer,
+                         std::size_t field,
+                         timer_id_type value
+                     )
+    {
+        _memory.ram[timer + field] = static_cast<int>(value);
+    }
+
+    void TimerWheel::Link(timer_id_type timer)
+    {
+        cycles_type expiry = GetExpiry(timer);
+        cycles_type delta = expiry - _current;
+        unsigned int level = 0;
+        while (level < LEVELS - 1 &&
+                   delta >= static_cast<cycles_type>(1) <<
+                                ((level + 1) * SLOT_BITS)) {
+            ++level;
+        }
+
+        // Farther than the top level reaches, it comes back down on the
+        //   next turn over
+        cycles_type reach =
+            static_cast<cycles_type>(1) << (LEVELS * SLOT_BITS);
+        if (delta >= reach) {
+            expiry = _current + reach - 1;
+        }
+
+        std::size_t index = (expiry >> (level * SLOT_BITS)) & (SLOTS - 1);
+        std::size_t slot = level * SLOTS + index;
+        timer_id_type next = _slots[slot];
+
+        SetField(timer, SLOT, slot);
+        SetField(timer, PREVIOUS, NO_TIMER);
+        SetField(timer, NEXT, next);
+        if (next != NO_TIMER) {
+            SetField(next, PREVIOUS, timer);
+        }
+        _slots[slot] = timer;
+
+        ++_level_counts[level];
+    }
+
+    void TimerWheel::Unlink(timer_id_type timer)
+    {
+        timer_id_type previous = GetField(timer, PREVIOUS);
+        timer_id_type next = GetField(timer, NEXT);
+        std::size_t slot = GetField(timer, SLOT);
+
+        if (previous != NO_TIMER) {
+            SetField(previous, NEXT, next);
+        } else {
+            _slots[slot] = next;
+        }
+        if (next != NO_TIMER) {
+            SetField(next, PREVIOUS, previous);
+        }
+
+        --_level_counts[slot / SLOTS];
+    }
+
+    void TimerWheel::Cascade(unsigned int level, std::size_t index)
+    {
+        timer_id_type timer = _slots[level * SLOTS + index];
+        _slots[level * SLOTS + index] = NO_TIMER;
+
+        while (timer != NO_TIMER) {
+            timer_id_type next = GetField(timer, NEXT);
+
+            --_level_counts[level];
+            Link(timer);
+
+            timer = next;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include "trace.h"
+
+#include <chrono>
+
+namespace svm
+{
+    namespace
+    {
+        std::atomic<unsigned long long> last_instance(0);
+
+        // The ring of the trace this thread recorded to last
+        thread_local unsigned long long cached_instance = 0;
+        thread_local void *cached_ring = NULL;
+
+        const std::chrono::milliseconds DRAIN_PERIOD(1);
+    }
+
+    Trace::Ring::Ring(std::thread::id owner, std::size_t capacity)
+        : owner(owner),
+          events(capacity),
+          head(0),
+          tail(0),
+          dropped(0) { }
+
+    Trace::Trace(const cycles_type *clock)
+        : _clock(clock),
+          _instance(++last_instance),
+          _level(Off),
+          _rings_mutex(),
+          _rings(),
+          _output(),
+          _stopping(false),
+          _drain() { }
+
+    Trace::~Trace()
+    {
+        Stop();
+    }
+
+    bool Trace::Start(const std::string &path, Levels level)
+    {
+        Stop();
+
+        _output.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!_output) {
+            return false;
+        }
+
+        unsigned int header[] = {
+            MAGIC, VERSION, static_cast<unsigned int>(sizeof(Event)), 0
+        };
+        _output.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+        _stopping = false;
+        _drain = std::thread(&Trace::Drain, this);
+        _level = level;
+
+        return true;
+    }
+
+    void Trace::Stop()
+    {
+        if (!_drain.joinable()) {
+            return;
+        }
+
+        _level = Off;
+        _stopping = true;
+        _drain.join();
+
+        DrainRings();
+
+        unsigned long long dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(_rings_mutex);
+            for (auto &ring : _rings) {
+                dropped += ring->dropped.exchange(0);
+            }
+        }
+        if (dropped > 0) {
+            Event event = {
+                *_clock,
+                Dropped,
+                static_cast<unsigned int>(KERNEL_PROCESS),
+                { static_cast<long long>(dropped), 0 }
+            };
+            _output.write(reinterpret_cast<const char *>(&event), sizeof(event));
+        }
+
+        _output.close();
+    }
+
+    bool Trace::IsEnabled(Levels level) const
+    {
+        return level <= _level.load(std::memory_order_relaxed);
+    }
+
+    void Trace::Record(
+                    Events type,
+                    unsigned int process_id,
+                    long long value0,
+                    long long value1
+                )
+    {
+        Ring *ring = GetRing();
+
+        std::size_t head = ring->head.load(std::memory_order_relaxed);
+        std::size_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head - tail == ring->events.size()) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Event &event = ring->events[head & (ring->events.size() - 1)];
+        event.cycle = *_clock;
+        event.type = type;
+        event.process_id = process_id;
+        event.values[0] = value0;
+        event.values[1] = value1;
+
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    Trace::Ring *Trace::GetRing()
+    {
+        if (cached_instance == _instance) {
+            return static_cast<Ring *>(cached_ring);
+        }
+
+        std::lock_guard<std::mutex> lock(_rings_mutex);
+
+        Ring *result = NULL;
+        std::thread::id thread = std::this_thread::get_id();
+        for (auto &ring : _rings) {
+            if (ring->owner == thread) {
+                result = ring.get();
+                break;
+            }
+        }
+        if (!result) {
+            _rings.push_back(
+                std::unique_ptr<Ring>(new Ring(thread, DEFAULT_RING_CAPACITY))
+            );
+            result = _rings.back().get();
+        }
+
+        cached_instance = _instance;
+        cached_ring = result;
+
+        return result;
+    }
+
+    void Trace::Drain()
+    {
+        while (!_stopping.load(std::memory_order_acquire)) {
+            if (!DrainRings()) {
+                std::this_thread::sleep_for(DRAIN_PERIOD);
+            }
+        }
+    }
+
+    bool Trace::DrainRings()
+    {
+        bool written = false;
+
+        std::lock_guard<std::mutex> lock(_rings_mutex);
+        for (auto &ring : _rings) {
+            std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+            std::size_t head = ring->head.load(std::memory_order_acquire);
+            std::size_t mask = ring->events.size() - 1;
+
+            // At most two contiguous pieces, the second one after the wrap
+            while (tail != head) {
+                std::size_t begin = tail & mask;
+                std::size_t count = head - tail;
+                if (count > ring->events.size() - begin) {
+                    count = ring->events.size() - begin;
+                }
+
+                _output.write(
+                    reinterpret_cast<const char *>(&ring->events[begin]),
+                    count * sizeof(Event)
+                );
+
+                tail += count;
+                written = true;
+            }
+
+            ring->tail.store(tail, std::memory_order_release);
+        }
+
+        return written;
+    }
+}
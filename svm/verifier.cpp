@@ -0,0 +1,94 @@
+#include "verifier.h"
+
+#include <algorithm>
+
+#include "cpu.h"
+
+namespace svm
+{
+    Verifier::Result::Result()
+        : verified(false),
+          pages() { }
+
+    Verifier::Result Verifier::Verify(
+                                  const int *text,
+                                  Memory::ram_size_type size,
+                                  Memory::page_table_size_type page_table_size,
+                                  const SyscallTable &syscalls
+                              )
+    {
+        Result result;
+
+        if (size == 0 || size % 2 != 0) {
+            return result;
+        }
+
+        for (Memory::ram_size_type ip = 0; ip < size; ip += 2) {
+            int instruction = text[ip];
+            int data = text[ip + 1];
+
+            switch (instruction) {
+                case CPU::MOVA_OPCODE:
+                case CPU::MOVB_OPCODE:
+                case CPU::MOVC_OPCODE:
+                case CPU::CPY_OPCODE:
+                case CPU::FILL_OPCODE:
+                case CPU::CMP_OPCODE:
+                case CPU::RDCYCLEA_OPCODE:
+                case CPU::RDCYCLEB_OPCODE:
+                case CPU::RDCYCLEC_OPCODE:
+                    break;
+                case CPU::JMP_OPCODE: {
+                    long long target = static_cast<long long>(ip) + data;
+                    if (data % 2 != 0 || target < 0 ||
+                            target >= static_cast<long long>(size)) {
+                        return result;
+                    }
+                    break;
+                }
+                case CPU::INT_OPCODE:
+                    if (!syscalls.IsRegistered(data)) {
+                        return result;
+                    }
+                    break;
+                case CPU::LDA_OPCODE:
+                case CPU::LDB_OPCODE:
+                case CPU::LDC_OPCODE:
+                case CPU::STA_OPCODE:
+                case CPU::STB_OPCODE:
+                case CPU::STC_OPCODE: {
+                    Memory::page_table_size_type page =
+                        static_cast<Memory::vmem_size_type>(data) /
+                            Memory::PAGE_SIZE;
+                    if (page >= page_table_size) {
+                        return result;
+                    }
+                    result.pages.push_back(page);
+                    break;
+                }
+                default:
+                    return result;
+            }
+        }
+
+        // Only a jump or the exit may be the last instruction, anything
+        //   else would continue with the words after the text
+        int last_instruction = text[size - 2];
+        int last_data = text[size - 1];
+        if (last_instruction != CPU::JMP_OPCODE &&
+                !(last_instruction == CPU::INT_OPCODE &&
+                      last_data == SyscallTable::EXIT)) {
+            return result;
+        }
+
+        std::sort(result.pages.begin(), result.pages.end());
+        result.pages.erase(
+            std::unique(result.pages.begin(), result.pages.end()),
+            result.pages.end()
+        );
+
+        result.verified = true;
+
+        return result;
+    }
+}
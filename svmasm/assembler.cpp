@@ -0,0 +1,670 @@
+#include "assembler.h"
+
+#include <climits>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace svmasm
+{
+    namespace
+    {
+        const char *MOV_OPCODE_TOKEN = "mov";
+        const char *JMP_OPCODE_TOKEN = "jmp";
+        const char *INT_OPCODE_TOKEN = "int";
+        const char *LD_OPCODE_TOKEN  = "ld";
+        const char *ST_OPCODE_TOKEN  = "st";
+        const char *CPY_OPCODE_TOKEN  = "cpy";
+        const char *FILL_OPCODE_TOKEN = "fill";
+        const char *CMP_OPCODE_TOKEN  = "cmp";
+        const char *RDCYCLE_OPCODE_TOKEN = "rdcycle";
+
+        const char *ENTRY_DIRECTIVE_TOKEN       = ".entry";
+        const char *PRIORITY_DIRECTIVE_TOKEN    = ".priority";
+        const char *BURST_DIRECTIVE_TOKEN       = ".burst";
+        const char *WORKING_SET_DIRECTIVE_TOKEN = ".working_set";
+        const char *DATA_DIRECTIVE_TOKEN        = ".data";
+        const char *WORD_DIRECTIVE_TOKEN        = ".word";
+        const char *BSS_DIRECTIVE_TOKEN         = ".bss";
+
+        bool IsSpace(char character)
+        {
+            return character == ' '  || character == '\t' ||
+                   character == '\r' || character == '\v' ||
+                   character == '\f';
+        }
+
+        bool IsCommentStart(char character)
+        {
+            return character == '#' || character == ';';
+        }
+
+        char ToLower(char character)
+        {
+            return (character >= 'A' && character <= 'Z') ?
+                       static_cast<char>(character - 'A' + 'a') : character;
+        }
+
+        bool IsLabelStart(char character)
+        {
+            character = ToLower(character);
+            return (character >= 'a' && character <= 'z') ||
+                   character == '_' || character == '.';
+        }
+
+        bool IsLabelCharacter(char character)
+        {
+            return IsLabelStart(character) ||
+                   (character >= '0' && character <= '9');
+        }
+
+        bool EqualsIgnoringCase(const Token &token, const char *keyword)
+        {
+            std::size_t i = 0;
+            for (; i < token.length; ++i) {
+                if (keyword[i] == '\0' || ToLower(token.begin[i]) != keyword[i]) {
+                    return false;
+                }
+            }
+
+            return keyword[i] == '\0';
+        }
+
+        bool IsLabel(const Token &token)
+        {
+            if (token.Empty() || !IsLabelStart(token.begin[0])) {
+                return false;
+            }
+            for (std::size_t i = 1; i < token.length; ++i) {
+                if (!IsLabelCharacter(token.begin[i])) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Decimal or `0x` hexadecimal with an optional sign
+        bool ParseNumber(const Token &token, int &number)
+        {
+            const char *current = token.begin;
+            const char *end = token.begin + token.length;
+
+            bool negative = false;
+            if (current != end && (*current == '-' || *current == '+')) {
+                negative = *current == '-';
+                ++current;
+            }
+
+            unsigned int base = 10;
+            if (end - current > 2 && current[0] == '0' &&
+                    ToLower(current[1]) == 'x') {
+                base = 16;
+                current += 2;
+            }
+
+            if (current == end) {
+                return false;
+            }
+
+            long long value = 0;
+            for (; current != end; ++current) {
+                char digit = ToLower(*current);
+                unsigned int digit_value;
+                if (digit >= '0' && digit <= '9') {
+                    digit_value = digit - '0';
+                } else if (base == 16 && digit >= 'a' && digit <= 'f') {
+                    digit_value = digit - 'a' + 10;
+                } else {
+                    return false;
+                }
+
+                value = value * base + digit_value;
+                if (value > static_cast<long long>(UINT_MAX)) {
+                    return false;
+                }
+            }
+
+            if (negative) {
+                value = -value;
+                if (value < INT_MIN) {
+                    return false;
+                }
+            }
+
+            // Hexadecimal words may use the sign bit (0xFFFFFFFF is -1)
+            number = static_cast<int>(static_cast<unsigned int>(value));
+
+            return value <= INT_MAX || base == 16;
+        }
+
+        bool ParseRegister(const Token &token, int &register_index)
+        {
+            if (token.length != 1) {
+                return false;
+            }
+
+            char name = ToLower(token.begin[0]);
+            if (name < 'a' || name > 'c') {
+                return false;
+            }
+            register_index = name - 'a';
+
+            return true;
+        }
+
+        // Splits lines into whitespace separated tokens without copying
+        class Lexer
+        {
+            public:
+                unsigned int line;
+
+                Lexer(const char *source, std::size_t size)
+                    : line(1),
+                      _current(source),
+                      _end(source + size) { }
+
+                bool AtEnd() const
+                {
+                    return _current >= _end;
+                }
+
+                // Returns false at the end of the line or at a comment
+                bool NextToken(Token &token)
+                {
+                    while (_current != _end && IsSpace(*_current)) {
+                        ++_current;
+                    }
+                    if (_current == _end || *_current == '\n' ||
+                            IsCommentStart(*_current)) {
+                        return false;
+                    }
+
+                    const char *begin = _current;
+                    while (_current != _end && !IsSpace(*_current) &&
+                               *_current != '\n' && !IsCommentStart(*_current)) {
+                        ++_current;
+                    }
+                    token = Token(begin, _current - begin);
+
+                    return true;
+                }
+
+                void NextLine()
+                {
+                    const void *line_end =
+                        std::memchr(_current, '\n', _end - _current);
+                    _current =
+                        line_end ?
+                            static_cast<const char *>(line_end) + 1 : _end;
+                    ++line;
+                }
+
+            private:
+                const char *_current;
+                const char *_end;
+        };
+
+        bool Fail(unsigned int line, const char *message, std::string &error)
+        {
+            error = std::to_string(line) + ": " + message;
+
+            return false;
+        }
+
+        // Takes one non-negative number operand
+        bool ParseCount(Lexer &lexer, int &count)
+        {
+            Token operand;
+
+            return lexer.NextToken(operand) &&
+                       ParseNumber(operand, count) && count >= 0;
+        }
+
+        bool ParseDirective(
+                 const Token &directive,
+                 Lexer &lexer,
+                 Program &program,
+                 std::string &error
+             )
+        {
+            Token operand;
+            if (EqualsIgnoringCase(directive, ENTRY_DIRECTIVE_TOKEN)) {
+                if (!lexer.NextToken(operand) || !IsLabel(operand)) {
+                    return Fail(lexer.line, "Invalid entry label.", error);
+                }
+                program.entry = operand;
+                program.entry_line = lexer.line;
+            } else if (EqualsIgnoringCase(directive, PRIORITY_DIRECTIVE_TOKEN)) {
+                if (!ParseCount(lexer, program.priority) ||
+                        program.priority > 0xFFFF) {
+                    return Fail(lexer.line, "Invalid priority.", error);
+                }
+            } else if (EqualsIgnoringCase(directive, BURST_DIRECTIVE_TOKEN)) {
+                if (!ParseCount(lexer, program.expected_burst)) {
+                    return Fail(lexer.line, "Invalid burst length.", error);
+                }
+            } else if (EqualsIgnoringCase(directive, WORKING_SET_DIRECTIVE_TOKEN)) {
+                if (!ParseCount(lexer, program.working_set)) {
+                    return Fail(lexer.line, "Invalid working set size.", error);
+                }
+            } else if (EqualsIgnoringCase(directive, DATA_DIRECTIVE_TOKEN)) {
+                if (program.has_data) {
+                    return Fail(lexer.line, "Duplicate data segment.", error);
+                }
+                if (!ParseCount(lexer, program.data_address)) {
+                    return Fail(lexer.line, "Invalid memory address.", error);
+                }
+                program.has_data = true;
+            } else if (EqualsIgnoringCase(directive, WORD_DIRECTIVE_TOKEN)) {
+                if (!program.has_data) {
+                    return Fail(lexer.line, "Data outside of a segment.", error);
+                }
+
+                int word;
+                bool any = false;
+                while (lexer.NextToken(operand)) {
+                    if (!ParseNumber(operand, word)) {
+                        return Fail(lexer.line, "Invalid data word.", error);
+                    }
+                    program.data.push_back(word);
+                    any = true;
+                }
+                if (!any) {
+                    return Fail(lexer.line, "Invalid data word.", error);
+                }
+            } else if (EqualsIgnoringCase(directive, BSS_DIRECTIVE_TOKEN)) {
+                if (program.bss_size > 0) {
+                    return Fail(lexer.line, "Duplicate bss segment.", error);
+                }
+                if (!ParseCount(lexer, program.bss_address) ||
+                        !ParseCount(lexer, program.bss_size)) {
+                    return Fail(lexer.line, "Invalid bss segment.", error);
+                }
+            } else {
+                return Fail(lexer.line, "Unknown directive.", error);
+            }
+
+            if (lexer.NextToken(operand)) {
+                return Fail(lexer.line, "Invalid assembly statement.", error);
+            }
+
+            return true;
+        }
+
+        std::size_t AlignToPage(std::size_t size)
+        {
+            return (size + OBJECT_PAGE_SIZE - 1) /
+                       OBJECT_PAGE_SIZE * OBJECT_PAGE_SIZE;
+        }
+
+        // Pages touched by `size` words at `address`
+        int CountPages(int address, std::size_t size)
+        {
+            if (size == 0) {
+                return 0;
+            }
+
+            std::size_t first_page = address / OBJECT_PAGE_SIZE;
+            std::size_t last_page = (address + size - 1) / OBJECT_PAGE_SIZE;
+
+            return static_cast<int>(last_page - first_page + 1);
+        }
+    }
+
+    Token::Token()
+        : begin(NULL),
+          length(0) { }
+
+    Token::Token(const char *begin, std::size_t length)
+        : begin(begin),
+          length(length) { }
+
+    bool Token::Empty() const
+    {
+        return length == 0;
+    }
+
+    bool Token::operator==(const Token &another_token) const
+    {
+        return length == another_token.length &&
+               std::memcmp(begin, another_token.begin, length) == 0;
+    }
+
+    std::string Token::ToString() const
+    {
+        return std::string(begin, length);
+    }
+
+    std::size_t TokenHash::operator()(const Token &token) const
+    {
+        // FNV-1a
+        std::size_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < token.length; ++i) {
+            hash ^= static_cast<unsigned char>(token.begin[i]);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    Instruction::Instruction()
+        : opcode(0),
+          data(0),
+          target(),
+          line(0) { }
+
+    Program::Program()
+        : instructions(),
+          labels(),
+          entry(),
+          entry_line(0),
+          priority(0),
+          expected_burst(-1),
+          working_set(-1),
+          has_data(false),
+          data_address(0),
+          data(),
+          bss_address(0),
+          bss_size(0) { }
+
+    void Program::Clear()
+    {
+        *this = Program();
+    }
+
+    SourceFile::SourceFile()
+        : _data(NULL),
+          _size(0) { }
+
+    SourceFile::~SourceFile()
+    {
+        if (_data && _size > 0) {
+            munmap(const_cast<char *>(_data), _size);
+        }
+    }
+
+    bool SourceFile::Open(const std::string &path)
+    {
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        bool opened = false;
+
+        struct stat status;
+        if (fstat(descriptor, &status) == 0) {
+            if (status.st_size == 0) {
+                _data = "";
+                _size = 0;
+                opened = true;
+            } else {
+                void *data =
+                    mmap(
+                        NULL,
+                        static_cast<std::size_t>(status.st_size),
+                        PROT_READ,
+                        MAP_PRIVATE,
+                        descriptor,
+                        0
+                    );
+                if (data != MAP_FAILED) {
+                    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+                    _data = static_cast<const char *>(data);
+                    _size = static_cast<std::size_t>(status.st_size);
+                    opened = true;
+                }
+            }
+        }
+
+        close(descriptor);
+
+        return opened;
+    }
+
+    const char *SourceFile::Data() const
+    {
+        return _data;
+    }
+
+    std::size_t SourceFile::Size() const
+    {
+        return _size;
+    }
+
+    bool Assembler::Parse(
+                        const char *source,
+                        std::size_t size,
+                        Program &program,
+                        std::string &error
+                    )
+    {
+        program.Clear();
+        // A statement takes about 10 characters
+        program.instructions.reserve(size / 10);
+
+        Lexer lexer(source, size);
+        for (; !lexer.AtEnd(); lexer.NextLine()) {
+            Token token;
+            if (!lexer.NextToken(token)) {
+                continue;
+            }
+
+            // `label:` marks the next instruction
+            if (token.begin[token.length - 1] == ':') {
+                Token label(token.begin, token.length - 1);
+                if (!IsLabel(label)) {
+                    return Fail(lexer.line, "Invalid label.", error);
+                }
+                if (!program.labels.insert(
+                        std::make_pair(label, program.instructions.size())
+                    ).second) {
+                    return Fail(lexer.line, "Duplicate label.", error);
+                }
+
+                if (!lexer.NextToken(token)) {
+                    continue;
+                }
+            }
+
+            if (token.begin[0] == '.') {
+                if (!ParseDirective(token, lexer, program, error)) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            Instruction instruction;
+            instruction.line = lexer.line;
+
+            Token operand;
+            int register_index;
+            if (EqualsIgnoringCase(token, MOV_OPCODE_TOKEN) ||
+                    EqualsIgnoringCase(token, LD_OPCODE_TOKEN) ||
+                    EqualsIgnoringCase(token, ST_OPCODE_TOKEN)) {
+                int base_opcode =
+                    EqualsIgnoringCase(token, MOV_OPCODE_TOKEN) ? MOVA_OPCODE :
+                        EqualsIgnoringCase(token, LD_OPCODE_TOKEN) ?
+                            LDA_OPCODE : STA_OPCODE;
+
+                if (!lexer.NextToken(operand)) {
+                    return Fail(lexer.line, "Invalid assembly statement.", error);
+                }
+                if (!ParseRegister(operand, register_index)) {
+                    return Fail(lexer.line, "Invalid register specifier.", error);
+                }
+                instruction.opcode = base_opcode + register_index;
+
+                if (!lexer.NextToken(operand) ||
+                        !ParseNumber(operand, instruction.data)) {
+                    return Fail(
+                               lexer.line,
+                               base_opcode == MOVA_OPCODE ?
+                                   "Invalid immediate value." :
+                                   "Invalid memory address.",
+                               error
+                           );
+                }
+            } else if (EqualsIgnoringCase(token, JMP_OPCODE_TOKEN)) {
+                instruction.opcode = JMP_OPCODE;
+
+                if (!lexer.NextToken(operand)) {
+                    return Fail(lexer.line, "Invalid relative address.", error);
+                }
+                if (IsLabel(operand)) {
+                    instruction.target = operand;
+                } else if (!ParseNumber(operand, instruction.data)) {
+                    return Fail(lexer.line, "Invalid relative address.", error);
+                }
+            } else if (EqualsIgnoringCase(token, INT_OPCODE_TOKEN)) {
+                instruction.opcode = INT_OPCODE;
+
+                if (!lexer.NextToken(operand) ||
+                        !ParseNumber(operand, instruction.data)) {
+                    return Fail(lexer.line, "Invalid interrupt number.", error);
+                }
+            } else if (EqualsIgnoringCase(token, CPY_OPCODE_TOKEN)) {
+                instruction.opcode = CPY_OPCODE;
+            } else if (EqualsIgnoringCase(token, FILL_OPCODE_TOKEN)) {
+                instruction.opcode = FILL_OPCODE;
+            } else if (EqualsIgnoringCase(token, CMP_OPCODE_TOKEN)) {
+                instruction.opcode = CMP_OPCODE;
+            } else if (EqualsIgnoringCase(token, RDCYCLE_OPCODE_TOKEN)) {
+                if (!lexer.NextToken(operand)) {
+                    return Fail(lexer.line, "Invalid assembly statement.", error);
+                }
+                if (!ParseRegister(operand, register_index)) {
+                    return Fail(lexer.line, "Invalid register specifier.", error);
+                }
+                instruction.opcode = RDCYCLEA_OPCODE + register_index;
+            } else {
+                return Fail(lexer.line, "Unknown instruction.", error);
+            }
+
+            if (lexer.NextToken(operand)) {
+                return Fail(lexer.line, "Invalid assembly statement.", error);
+            }
+
+            program.instructions.push_back(instruction);
+        }
+
+        return true;
+    }
+
+    bool Assembler::Emit(
+                        const Program &program,
+                        std::vector<int> &ops,
+                        std::string &error
+                    )
+    {
+        int entry = 0;
+        if (!program.entry.Empty()) {
+            auto label = program.labels.find(program.entry);
+            if (label == program.labels.end() ||
+                    label->second >= program.instructions.size()) {
+                return Fail(program.entry_line, "Undefined entry label.", error);
+            }
+            entry = 2 * static_cast<int>(label->second);
+        }
+
+        int segments_count = 1 + (program.has_data ? 1 : 0) +
+                                 (program.bss_size > 0 ? 1 : 0);
+
+        std::size_t text_offset =
+            AlignToPage(OBJECT_HEADER_SIZE + segments_count * OBJECT_SEGMENT_SIZE);
+        std::size_t text_size = program.instructions.size() * 2;
+        std::size_t data_offset = AlignToPage(text_offset + text_size);
+        std::size_t data_size = program.data.size();
+
+        // Straight-line code runs every instruction once, the data the
+        //   program starts with is what it touches first
+        int expected_burst =
+            program.expected_burst >= 0 ?
+                program.expected_burst :
+                static_cast<int>(program.instructions.size());
+        int working_set =
+            program.working_set >= 0 ?
+                program.working_set :
+                CountPages(program.data_address, data_size) +
+                    CountPages(program.bss_address, program.bss_size);
+
+        ops.clear();
+        ops.reserve(data_offset + data_size);
+
+        ops.push_back(OBJECT_MAGIC);
+        ops.push_back(OBJECT_VERSION);
+        ops.push_back(entry);
+        ops.push_back(program.priority);
+        ops.push_back(expected_burst);
+        ops.push_back(working_set);
+        ops.push_back(segments_count);
+
+        auto push_segment = [&](
+                                int type,
+                                std::size_t offset,
+                                std::size_t file_size,
+                                int address,
+                                std::size_t memory_size
+                            ) {
+            ops.push_back(type);
+            ops.push_back(static_cast<int>(offset));
+            ops.push_back(static_cast<int>(file_size));
+            ops.push_back(address);
+            ops.push_back(static_cast<int>(memory_size));
+        };
+
+        push_segment(TEXT_SEGMENT, text_offset, text_size, 0, text_size);
+        if (program.has_data) {
+            push_segment(
+                DATA_SEGMENT,
+                data_offset,
+                data_size,
+                program.data_address,
+                data_size
+            );
+        }
+        if (program.bss_size > 0) {
+            push_segment(
+                BSS_SEGMENT,
+                AlignToPage(data_offset + data_size),
+                0,
+                program.bss_address,
+                program.bss_size
+            );
+        }
+        ops.resize(text_offset, 0);
+
+        for (std::size_t i = 0; i < program.instructions.size(); ++i) {
+            const Instruction &instruction = program.instructions[i];
+
+            int data = instruction.data;
+            if (!instruction.target.Empty()) {
+                auto label = program.labels.find(instruction.target);
+                if (label == program.labels.end()) {
+                    return Fail(instruction.line, "Undefined label.", error);
+                }
+
+                // `jmp` is relative to its own address, two words per
+                //   instruction
+                data =
+                    2 * (static_cast<int>(label->second) - static_cast<int>(i));
+            }
+
+            ops.push_back(instruction.opcode);
+            ops.push_back(data);
+        }
+
+        if (program.has_data) {
+            ops.resize(data_offset, 0);
+            ops.insert(ops.end(), program.data.begin(), program.data.end());
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,156 @@
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace svmasm
+{
+    static const int MOVA_OPCODE = 0x10;
+    static const int MOVB_OPCODE = 0x11;
+    static const int MOVC_OPCODE = 0x12;
+
+    static const int JMP_OPCODE = 0x20;
+
+    static const int INT_OPCODE = 0x30;
+
+    static const int LDA_OPCODE = 0x40;
+    static const int LDB_OPCODE = 0x41;
+    static const int LDC_OPCODE = 0x42;
+
+    static const int STA_OPCODE = 0x50;
+    static const int STB_OPCODE = 0x51;
+    static const int STC_OPCODE = 0x52;
+
+    // Block instructions take their operands in registers: `a` is the
+    //   destination, `b` the source (or the fill value), `c` the count
+    static const int CPY_OPCODE  = 0x60;
+    static const int FILL_OPCODE = 0x61;
+    static const int CMP_OPCODE  = 0x62;
+
+    // `rdcycle r` loads the virtual cycle counter into the register
+    static const int RDCYCLEA_OPCODE = 0x70;
+    static const int RDCYCLEB_OPCODE = 0x71;
+    static const int RDCYCLEC_OPCODE = 0x72;
+
+    // SVM object format (read by the loader in `svm/executable.cpp`)
+    //
+    //   magic, version, entry, priority, expected burst, working set,
+    //   segments count, then per segment: type, file offset, file size,
+    //   virtual address, memory size
+    //
+    // All values are in words, file offsets are multiples of the page size
+    static const int OBJECT_MAGIC        = 0x584d5653; // "SVMX"
+    static const int OBJECT_VERSION      = 1;
+    static const int OBJECT_HEADER_SIZE  = 7;
+    static const int OBJECT_SEGMENT_SIZE = 5;
+    static const int OBJECT_PAGE_SIZE    = 0x80;
+
+    static const int TEXT_SEGMENT = 0;
+    static const int DATA_SEGMENT = 1;
+    static const int BSS_SEGMENT  = 2;
+
+    // A piece of the source text, points into the mapped input file
+    struct Token
+    {
+        const char *begin;
+        std::size_t length;
+
+        Token();
+        Token(const char *begin, std::size_t length);
+
+        bool Empty() const;
+        bool operator==(const Token &another_token) const;
+
+        std::string ToString() const;
+    };
+
+    struct TokenHash
+    {
+        std::size_t operator()(const Token &token) const;
+    };
+
+    // One statement of the program (the IR between parsing and emission)
+    struct Instruction
+    {
+        int opcode;
+        int data;        // Immediate, address or relative jump in words
+        Token target;    // Label of a `jmp`, empty for a numeric operand
+        unsigned int line;
+
+        Instruction();
+    };
+
+    struct Program
+    {
+        typedef std::unordered_map<Token, std::size_t, TokenHash> labels_type;
+
+        std::vector<Instruction> instructions;
+        labels_type labels; // Label -> index of the instruction it marks
+
+        // Directives. Hints left at -1 are estimated by `Emit`
+        Token entry;              // `.entry label`, the first instruction
+                                  //   if empty
+        unsigned int entry_line;
+        int priority;             // `.priority n`
+        int expected_burst;       // `.burst n`, instructions
+        int working_set;          // `.working_set n`, pages
+
+        bool has_data;
+        int data_address;         // `.data address`
+        std::vector<int> data;    // `.word n...`
+        int bss_address;          // `.bss address size`
+        int bss_size;
+
+        Program();
+
+        void Clear();
+    };
+
+    // Read-only view of an input file mapped into memory
+    class SourceFile
+    {
+        public:
+            SourceFile();
+            virtual ~SourceFile();
+
+            bool Open(const std::string &path);
+
+            const char *Data() const;
+            std::size_t Size() const;
+
+        private:
+            SourceFile(const SourceFile &);
+            SourceFile &operator=(const SourceFile &);
+
+            const char *_data;
+            std::size_t _size;
+    };
+
+    // Converts assembly code to virtual CPU instructions
+    //     `mov a 42` -> `0x10 0x2A`
+    //
+    // Pass 1 (`Parse`) lexes the source in place and builds the IR and the
+    // label table. Pass 2 (`Emit`) resolves `jmp` labels into relative
+    // offsets and encodes the words of an object file
+    class Assembler
+    {
+        public:
+            // On failure `error` has "<line>: <message>"
+            static bool Parse(
+                            const char *source,
+                            std::size_t size,
+                            Program &program,
+                            std::string &error
+                        );
+            static bool Emit(
+                            const Program &program,
+                            std::vector<int> &ops,
+                            std::string &error
+                        );
+    };
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <cstddef>
+
+#include "assembler.h"
+
+namespace svmasm
+{
+    struct OptimizerStatistics
+    {
+        std::size_t instructions_before;
+        std::size_t instructions_after;
+
+        std::size_t dead_writes;     // `mov`s overwritten before any use
+        std::size_t threaded_jumps;  // jumps retargeted past other jumps
+        std::size_t forwarded_loads; // `ld`s after a `st` to the address
+        std::size_t removed_noops;   // jumps to the next instruction
+
+        std::size_t skipped_programs; // programs with jumps into the middle
+                                      //   of an instruction
+
+        OptimizerStatistics();
+
+        OptimizerStatistics &operator+=(
+                                 const OptimizerStatistics &statistics
+                             );
+    };
+
+    // Peephole Optimizer
+    //
+    // Runs on the IR between `Assembler::Parse` and `Assembler::Emit`.
+    // Blocks start at jump targets and labels and end after a `jmp`. At the
+    // end of a block every register is assumed live and memory facts are
+    // dropped, so the passes never reason across control flow. Only `int`
+    // may change memory behind the program, stores of other processes to
+    // shared pages between two loads are just one possible interleaving
+    class Optimizer
+    {
+        public:
+            // All jumps are numeric relative jumps in the result
+            static void Optimize(
+                            Program &program,
+                            OptimizerStatistics &statistics
+                        );
+    };
+}
+
+#endif
@@ -0,0 +1,394 @@
+#include "optimizer.h"
+
+#include <map>
+#include <vector>
+
+namespace svmasm
+{
+    namespace
+    {
+        const int REGISTERS_COUNT = 3;
+        const long NO_TARGET = -1;
+
+        bool IsMov(int opcode)
+        {
+            return opcode >= MOVA_OPCODE && opcode <= MOVC_OPCODE;
+        }
+
+        bool IsLd(int opcode)
+        {
+            return opcode >= LDA_OPCODE && opcode <= LDC_OPCODE;
+        }
+
+        bool IsSt(int opcode)
+        {
+            return opcode >= STA_OPCODE && opcode <= STC_OPCODE;
+        }
+
+        bool IsRdcycle(int opcode)
+        {
+            return opcode >= RDCYCLEA_OPCODE && opcode <= RDCYCLEC_OPCODE;
+        }
+
+        // Working copy of the program with jumps as instruction indices
+        struct Function
+        {
+            std::vector<Instruction> instructions;
+            std::vector<long> targets;  // NO_TARGET for non-jumps
+            std::vector<bool> leaders;  // first instructions of blocks
+            std::vector<bool> removed;
+        };
+
+        void FindLeaders(Function &function, const Program &program)
+        {
+            std::size_t count = function.instructions.size();
+
+            function.leaders.assign(count + 1, false);
+            function.leaders[0] = true;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (function.targets[i] != NO_TARGET) {
+                    function.leaders[function.targets[i]] = true;
+                    function.leaders[i + 1] = true;
+                }
+            }
+            for (auto &label : program.labels) {
+                if (label.second <= count) {
+                    function.leaders[label.second] = true;
+                }
+            }
+        }
+
+        std::size_t ThreadJumps(Function &function)
+        {
+            std::size_t threaded_jumps = 0;
+
+            std::size_t count = function.instructions.size();
+            for (std::size_t i = 0; i < count; ++i) {
+                long target = function.targets[i];
+                if (target == NO_TARGET) {
+                    continue;
+                }
+
+                // Follow the chain, a chain longer than the program is a
+                //   cycle of jumps and is left alone
+                long final_target = target;
+                std::size_t steps = 0;
+                for (; steps <= count &&
+                           static_cast<std::size_t>(final_target) < count &&
+                           function.targets[final_target] != NO_TARGET;
+                       ++steps) {
+                    final_target = function.targets[final_target];
+                }
+
+                if (steps <= count && final_target != target) {
+                    function.targets[i] = final_target;
+                    ++threaded_jumps;
+                }
+            }
+
+            return threaded_jumps;
+        }
+
+        std::size_t RemoveNoops(Function &function)
+        {
+            std::size_t removed_noops = 0;
+
+            for (std::size_t i = 0; i < function.instructions.size(); ++i) {
+                if (!function.removed[i] &&
+                        function.targets[i] == static_cast<long>(i + 1)) {
+                    function.removed[i] = true;
+                    ++removed_noops;
+                }
+            }
+
+            return removed_noops;
+        }
+
+        // Forward scan per block. Tracks which register version and which
+        //   constant each memory word holds since the last `st`
+        std::size_t ForwardLoads(Function &function)
+        {
+            struct Value
+            {
+                int register_index;
+                unsigned long version;
+                bool constant_known;
+                int constant;
+            };
+
+            std::size_t forwarded_loads = 0;
+
+            unsigned long versions[REGISTERS_COUNT] = { 0, 0, 0 };
+            bool constants_known[REGISTERS_COUNT] = { false, false, false };
+            int constants[REGISTERS_COUNT] = { 0, 0, 0 };
+            std::map<int, Value> memory;
+
+            auto forget_everything = [&]() {
+                for (int r = 0; r < REGISTERS_COUNT; ++r) {
+                    ++versions[r];
+                    constants_known[r] = false;
+                }
+                memory.clear();
+            };
+
+            for (std::size_t i = 0; i < function.instructions.size(); ++i) {
+                if (function.leaders[i]) {
+                    forget_everything();
+                }
+                if (function.removed[i]) {
+                    continue;
+                }
+
+                Instruction &instruction = function.instructions[i];
+                int opcode = instruction.opcode;
+                if (IsMov(opcode)) {
+                    int r = opcode - MOVA_OPCODE;
+                    ++versions[r];
+                    constants_known[r] = true;
+                    constants[r] = instruction.data;
+                } else if (IsSt(opcode)) {
+                    int r = opcode - STA_OPCODE;
+                    Value value = {
+                        r, versions[r], constants_known[r], constants[r]
+                    };
+                    memory[instruction.data] = value;
+                } else if (IsLd(opcode)) {
+                    int r = opcode - LDA_OPCODE;
+
+                    auto stored = memory.find(instruction.data);
+                    if (stored != memory.end()) {
+                        Value &value = stored->second;
+                        if (value.register_index == r &&
+                                value.version == versions[r]) {
+                            // The register still holds the stored value
+                            function.removed[i] = true;
+                            ++forwarded_loads;
+                            continue;
+                        }
+                        if (value.constant_known) {
+                            // No page walk for a value known at assembly
+                            //   time
+                            instruction.opcode = MOVA_OPCODE + r;
+                            instruction.data = value.constant;
+                            ++forwarded_loads;
+
+                            ++versions[r];
+                            constants_known[r] = true;
+                            constants[r] = value.constant;
+                            continue;
+                        }
+                    }
+
+                    ++versions[r];
+                    constants_known[r] = false;
+                    if (stored != memory.end() && stored->second.constant_known) {
+                        constants_known[r] = true;
+                        constants[r] = stored->second.constant;
+                    }
+
+                    Value value = {
+                        r, versions[r], constants_known[r], constants[r]
+                    };
+                    memory[instruction.data] = value;
+                } else if (IsRdcycle(opcode)) {
+                    int r = opcode - RDCYCLEA_OPCODE;
+                    ++versions[r];
+                    constants_known[r] = false;
+                } else {
+                    // `int` and the block instructions may change registers
+                    //   and memory, `jmp` ends the block
+                    forget_everything();
+                }
+            }
+
+            return forwarded_loads;
+        }
+
+        // Backward scan per block, every register is live at the block end
+        //   and at `int` (system call arguments)
+        std::size_t RemoveDeadWrites(Function &function)
+        {
+            std::size_t dead_writes = 0;
+
+            bool live[REGISTERS_COUNT] = { true, true, true };
+            auto make_all_live = [&]() {
+                for (int r = 0; r < REGISTERS_COUNT; ++r) {
+                    live[r] = true;
+                }
+            };
+
+            for (std::size_t i = function.instructions.size(); i-- > 0;) {
+                if (function.leaders[i + 1]) {
+                    make_all_live();
+                }
+                if (function.removed[i]) {
+                    continue;
+                }
+
+                int opcode = function.instructions[i].opcode;
+                if (IsMov(opcode)) {
+                    int r = opcode - MOVA_OPCODE;
+                    if (!live[r]) {
+                        function.removed[i] = true;
+                        ++dead_writes;
+                    }
+                    live[r] = false;
+                } else if (IsLd(opcode)) {
+                    // Kept even if dead, the access may fault in a page
+                    live[opcode - LDA_OPCODE] = false;
+                } else if (IsSt(opcode)) {
+                    live[opcode - STA_OPCODE] = true;
+                } else if (IsRdcycle(opcode)) {
+                    // Kept even if dead, it marks a point in time
+                    live[opcode - RDCYCLEA_OPCODE] = false;
+                } else {
+                    // `int` and the block instructions read registers
+                    make_all_live();
+                }
+            }
+
+            return dead_writes;
+        }
+
+        // Drops removed instructions, a jump to a removed instruction lands
+        //   on the next one that is left
+        void Compact(Function &function, Program &program)
+        {
+            std::size_t count = function.instructions.size();
+
+            std::vector<long> new_indices(count + 1);
+            long next_index = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                new_indices[i] = next_index;
+                if (!function.removed[i]) {
+                    ++next_index;
+                }
+            }
+            new_indices[count] = next_index;
+
+            std::vector<Instruction> instructions;
+            std::vector<long> targets;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (function.removed[i]) {
+                    continue;
+                }
+
+                instructions.push_back(function.instructions[i]);
+                targets.push_back(
+                    function.targets[i] == NO_TARGET ?
+                        NO_TARGET : new_indices[function.targets[i]]
+                );
+            }
+
+            for (auto &label : program.labels) {
+                label.second = new_indices[label.second];
+            }
+
+            function.instructions.swap(instructions);
+            function.targets.swap(targets);
+            function.removed.assign(function.instructions.size(), false);
+        }
+    }
+
+    OptimizerStatistics::OptimizerStatistics()
+        : instructions_before(0),
+          instructions_after(0),
+          dead_writes(0),
+          threaded_jumps(0),
+          forwarded_loads(0),
+          removed_noops(0),
+          skipped_programs(0) { }
+
+    OptimizerStatistics &OptimizerStatistics::operator+=(
+                                                  const OptimizerStatistics &statistics
+                                              )
+    {
+        instructions_before += statistics.instructions_before;
+        instructions_after += statistics.instructions_after;
+        dead_writes += statistics.dead_writes;
+        threaded_jumps += statistics.threaded_jumps;
+        forwarded_loads += statistics.forwarded_loads;
+        removed_noops += statistics.removed_noops;
+        skipped_programs += statistics.skipped_programs;
+
+        return *this;
+    }
+
+    void Optimizer::Optimize(
+                        Program &program,
+                        OptimizerStatistics &statistics
+                    )
+    {
+        std::size_t count = program.instructions.size();
+        statistics.instructions_before += count;
+
+        Function function;
+        function.instructions = program.instructions;
+        function.targets.assign(count, NO_TARGET);
+        function.removed.assign(count, false);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const Instruction &instruction = program.instructions[i];
+            if (instruction.opcode != JMP_OPCODE) {
+                continue;
+            }
+
+            long target;
+            if (!instruction.target.Empty()) {
+                auto label = program.labels.find(instruction.target);
+                if (label == program.labels.end()) {
+                    // Left for `Emit` to report
+                    statistics.instructions_after += count;
+                    return;
+                }
+                target = static_cast<long>(label->second);
+            } else {
+                // Two words per instruction, anything else lands inside an
+                //   instruction or outside of the program
+                target = static_cast<long>(i) + instruction.data / 2;
+                if (instruction.data % 2 != 0 ||
+                        target < 0 || target > static_cast<long>(count)) {
+                    ++statistics.skipped_programs;
+                    statistics.instructions_after += count;
+                    return;
+                }
+            }
+
+            function.targets[i] = target;
+        }
+
+        // Each pass may expose work for the others
+        for (;;) {
+            FindLeaders(function, program);
+
+            std::size_t threaded_jumps = ThreadJumps(function);
+            std::size_t removed_noops = RemoveNoops(function);
+            std::size_t forwarded_loads = ForwardLoads(function);
+            std::size_t dead_writes = RemoveDeadWrites(function);
+
+            Compact(function, program);
+
+            statistics.threaded_jumps += threaded_jumps;
+            statistics.removed_noops += removed_noops;
+            statistics.forwarded_loads += forwarded_loads;
+            statistics.dead_writes += dead_writes;
+
+            if (threaded_jumps + removed_noops +
+                    forwarded_loads + dead_writes == 0) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < function.instructions.size(); ++i) {
+            Instruction &instruction = function.instructions[i];
+            if (function.targets[i] != NO_TARGET) {
+                instruction.target = Token();
+                instruction.data =
+                    2 * static_cast<int>(function.targets[i] - static_cast<long>(i));
+            }
+        }
+
+        program.instructions.swap(function.instructions);
+        statistics.instructions_after += program.instructions.size();
+    }
+}
@@ -1,199 +1,201 @@
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <iostream>
 #include <string>
-#include <sstream>
+#include <thread>
 #include <vector>
-#include <algorithm>
-#include <cctype>
-
-static const char *REGISTER_A_TOKEN = "a";
-static const char *REGISTER_B_TOKEN = "b";
-static const char *REGISTER_C_TOKEN = "c";
-
-static const char *MOV_OPCODE_TOKEN = "mov";
-static const int MOVA_OPCODE = 0x10;
-static const int MOVB_OPCODE = 0x11;
-static const int MOVC_OPCODE = 0x12;
-
-static const char *JMP_OPCODE_TOKEN = "jmp";
-static const int JMP_OPCODE = 0x20;
-
-static const char *INT_OPCODE_TOKEN = "int";
-static const int INT_OPCODE = 0x30;
-
-/*
- *  TODO:
- *
- *    Add instruction encoding for `ld` operations.
- *
- *      static const char *LD_OPCODE_TOKEN = "ld";
- *      static const int LDA_OPCODE = 0x40;
- *      static const int LDB_OPCODE = 0x41;
- *      ...
- */
-
-/*
- *  TODO:
- *
- *    Add instruction encoding for `st` operations.
- *
- *      static const char *ST_OPCODE_TOKEN = "st";
- *      static const int STA_OPCODE = 0x50;
- *      static const int STB_OPCODE = 0x51;
- *      ...
- */
-
-// Converts assembly code to virtual CPU instructions
-//     `mov a 42` -> `0x10 0x2A`
 
-int main(int argc, char *argv[])
+#include "assembler.h"
+#include "optimizer.h"
+
+using namespace svmasm;
+
+// Assembles one file, returns an empty string on success or an error
+static std::string AssembleFile(
+                       const std::string &input_file_name,
+                       const std::string &output_file_name,
+                       bool optimize,
+                       OptimizerStatistics &statistics,
+                       std::size_t &source_size
+                   )
 {
-    if (argc >= 3) {
-        std::string input_file;
+    source_size = 0;
 
-        std::string input_file_name(argv[1]);
-        std::string output_file_name(argv[2]);
+    SourceFile source;
+    if (!source.Open(input_file_name)) {
+        return "Failed to open the input file.";
+    }
+    source_size = source.Size();
 
-        std::ifstream input_stream(argv[1]);
-        if (!input_stream) {
-            std::cerr << "Failed to open the input file."
-                      << std::endl;
+    Program program;
+    std::vector<int> ops;
+    std::string error;
+    if (!Assembler::Parse(source.Data(), source.Size(), program, error)) {
+        return input_file_name + ":" + error;
+    }
+    if (optimize) {
+        Optimizer::Optimize(program, statistics);
+    }
+    if (!Assembler::Emit(program, ops, error)) {
+        return input_file_name + ":" + error;
+    }
 
-            return -1;
-        }
+    std::ofstream output_stream(
+        output_file_name,
+        std::ios::out | std::ios::binary
+    );
+    if (!output_stream) {
+        return "Failed to open the output file.";
+    }
 
-        std::ofstream output_stream(
-            argv[2],
-            std::ios::out | std::ios::binary
+    if (!ops.empty()) {
+        output_stream.write(
+            reinterpret_cast<const char *>(&ops[0]),
+            ops.size() * sizeof(int)
         );
-        if (!output_stream) {
-            std::cerr << "Failed to open the output file."
-                      << std::endl;
-
-            return -1;
-        }
+    }
 
-        std::vector<int> ops;
+    if (output_stream.bad()) {
+        return "Failed to write the output file.";
+    }
 
-        for (std::string line; std::getline(input_stream, line);) {
-            std::stringstream tokens(line); std::string token;
-            if (tokens >> token) {
-                std::transform(
-                    token.begin(),
-                    token.end(),
-                    token.begin(),
-                    tolower
-                );
+    return std::string();
+}
 
-                if (token == MOV_OPCODE_TOKEN) {
-                    int instruction, data;
-                    if (tokens >> token) {
-                        std::transform(
-                            token.begin(),
-                            token.end(),
-                            token.begin(),
-                            tolower
-                        );
-
-                        if (token == REGISTER_A_TOKEN) {
-                            instruction = MOVA_OPCODE;
-                        } else if (token == REGISTER_B_TOKEN) {
-                            instruction = MOVB_OPCODE;
-                        } else if (token == REGISTER_C_TOKEN) {
-                            instruction = MOVC_OPCODE;
-                        } else {
-                            std::cerr << "Invalid register specifier."
-                                      << std::endl;
-
-                            return -1;
-                        }
-
-                        if (!(tokens >> data)) {
-                            std::cerr << "Invalid immediate value."
-                                      << std::endl;
-
-                            return -1;
-                        }
-
-                        ops.push_back(instruction);
-                        ops.push_back(data);
-                    } else {
-                        std::cerr << "Invalid assembly statement."
-                                  << std::endl;
-
-                        return -1;
-                    }
-                } else if (token == JMP_OPCODE_TOKEN) {
-                    int instruction =
-                        JMP_OPCODE;
-
-                    int data;
-                    if (!(tokens >> data)) {
-                        std::cerr << "Invalid relative address."
-                                  << std::endl;
-
-                        return -1;
-                    }
-
-                    ops.push_back(instruction);
-                    ops.push_back(data);
-                } else if (token == INT_OPCODE_TOKEN) {
-                    int instruction =
-                        INT_OPCODE;
-
-                    int data;
-                    if (!(tokens >> data)) {
-                        std::cerr << "Invalid interrupt number."
-                                  << std::endl;
-
-                        return -1;
-                    }
-
-                    ops.push_back(instruction);
-                    ops.push_back(data);
-                }
-                /*
-                 *  TODO:
-                 *
-                 *      else if (token == LD_OPCODE_TOKEN) {
-                 *        // use code from the MOV branch as an example
-                 *        ...
-                 *    } else if (token == ST_OPCODE_TOKEN) {
-                 *        // use code from the MOV branch as an example
-                 *        ...
-                 *    }
-                 */
-            }
-
-            input_file.append(line);
-        }
+// `name.asm` -> `name.bin`
+static std::string GetBatchOutputFileName(const std::string &input_file_name)
+{
+    std::string::size_type extension = input_file_name.rfind('.');
+    std::string::size_type directory = input_file_name.find_last_of("/\\");
+    if (extension == std::string::npos ||
+            (directory != std::string::npos && extension < directory)) {
+        return input_file_name + ".bin";
+    }
 
-        if (input_stream.bad()) {
-            std::cerr << "Failed to read the input file."
-                      << std::endl;
+    return input_file_name.substr(0, extension) + ".bin";
+}
 
-            return -1;
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> input_file_names;
+    std::vector<std::string> output_file_names;
+    unsigned int jobs_count = std::thread::hardware_concurrency();
+
+    bool batch = false;
+    bool optimize = false;
+    int argument_index = 1;
+    for (; argument_index < argc; ++argument_index) {
+        std::string argument(argv[argument_index]);
+        if (argument == "-b") {
+            batch = true;
+        } else if (argument == "-O0" || argument == "-O1") {
+            optimize = argument == "-O1";
+        } else if (argument == "-j" && argument_index + 1 < argc) {
+            jobs_count =
+                std::strtoul(argv[++argument_index], NULL, 10);
+        } else {
+            break;
         }
+    }
 
-        output_stream.write(
-            reinterpret_cast<const char *>(&ops[0]),
-            ops.size() * sizeof(int)
-        );
-
-        if (output_stream.bad()) {
-            std::cerr << "Failed to write the output file."
-                      << std::endl;
-
-            return -1;
+    if (batch && argument_index < argc) {
+        for (; argument_index < argc; ++argument_index) {
+            input_file_names.push_back(argv[argument_index]);
+            output_file_names.push_back(
+                GetBatchOutputFileName(argv[argument_index])
+            );
         }
+    } else if (!batch && argc - argument_index >= 2) {
+        input_file_names.push_back(argv[argument_index]);
+        output_file_names.push_back(argv[argument_index + 1]);
     } else {
         std::cerr << "The syntax of the command is incorrect."
                   << std::endl
-                  << " vmasm <input file> <output file>"
+                  << " vmasm [-O0|-O1] <input file> <output file>"
+                  << std::endl
+                  << " vmasm [-O0|-O1] [-j <jobs>] -b <input files>"
                   << std::endl << std::endl;
 
         return -1;
     }
 
-    return 0;
+    if (jobs_count == 0) {
+        jobs_count = 1;
+    }
+    if (jobs_count > input_file_names.size()) {
+        jobs_count = static_cast<unsigned int>(input_file_names.size());
+    }
+
+    std::vector<std::string> errors(input_file_names.size());
+    std::vector<std::size_t> sizes(input_file_names.size());
+    std::vector<OptimizerStatistics> statistics(input_file_names.size());
+    std::atomic<std::size_t> next_file(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Files are independent, workers take the next one until none is left
+    auto worker = [&]() {
+        for (std::size_t file = next_file++;
+                 file < input_file_names.size(); file = next_file++) {
+            errors[file] =
+                AssembleFile(
+                    input_file_names[file],
+                    output_file_names[file],
+                    optimize,
+                    statistics[file],
+                    sizes[file]
+                );
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < jobs_count; ++i) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    double seconds =
+        std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+
+    int result = 0;
+    std::size_t total_size = 0;
+    OptimizerStatistics total_statistics;
+    for (std::size_t file = 0; file < input_file_names.size(); ++file) {
+        if (!errors[file].empty()) {
+            std::cerr << errors[file] << std::endl;
+            result = -1;
+        }
+        total_size += sizes[file];
+        total_statistics += statistics[file];
+    }
+
+    double megabytes = total_size / (1024.0 * 1024.0);
+    std::cerr << "svmasm: " << input_file_names.size() << " file(s), "
+              << megabytes << " MB in " << seconds * 1000.0 << " ms ("
+              << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s)."
+              << std::endl;
+
+    if (optimize) {
+        std::cerr << "svmasm: " << total_statistics.instructions_before
+                  << " -> " << total_statistics.instructions_after
+                  << " instruction(s), "
+                  << total_statistics.dead_writes << " dead write(s), "
+                  << total_statistics.forwarded_loads << " forwarded load(s), "
+                  << total_statistics.threaded_jumps << " threaded jump(s), "
+                  << total_statistics.removed_noops << " removed no-op(s)";
+        if (total_statistics.skipped_programs > 0) {
+            std::cerr << ", " << total_statistics.skipped_programs
+                      << " file(s) with jumps into instructions left as is";
+        }
+        std::cerr << "." << std::endl;
+    }
+
+    return result;
 }
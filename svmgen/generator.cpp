@@ -0,0 +1,317 @@
+#include "generator.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace svmgen
+{
+    namespace
+    {
+        // Addresses of the loads and stores of one program. Pages of the
+        //   footprint are touched for the first time in the order of the
+        //   pattern, the other accesses follow it over the touched ones
+        class AccessStream
+        {
+            public:
+                AccessStream(
+                    const ProcessClass &process_class,
+                    RandomStream &random
+                ) : _class(process_class),
+                    _random(random),
+                    _pages(),
+                    _touched(0),
+                    _position(0)
+                {
+                    int pages_count = random.Draw(process_class.footprint);
+                    for (int page = 0; page < pages_count; ++page) {
+                        _pages.push_back(page);
+                    }
+                    if (process_class.pattern == Random) {
+                        for (std::size_t i = _pages.size(); i > 1; --i) {
+                            std::swap(
+                                _pages[i - 1],
+                                _pages[random.Next(static_cast<unsigned int>(i))]
+                            );
+                        }
+                    }
+                }
+
+                int Next()
+                {
+                    if (_touched < _pages.size() &&
+                            (_touched == 0 ||
+                                 _random.Chance(_class.fault_rate))) {
+                        ++_touched;
+                        _position = static_cast<unsigned int>(
+                                        (_touched - 1) * PAGE_SIZE
+                                    );
+                        if (_class.pattern == Random) {
+                            _position += _random.Next(PAGE_SIZE);
+                        }
+                    } else {
+                        unsigned int words =
+                            static_cast<unsigned int>(_touched * PAGE_SIZE);
+                        if (_class.pattern == Sequential) {
+                            _position = (_position + 1) % words;
+                        } else if (_class.pattern == Strided) {
+                            _position = (_position + _class.stride) % words;
+                        } else {
+                            _position = _random.Next(words);
+                        }
+                    }
+
+                    return ToAddress(_position);
+                }
+
+                // A touched page for a disk buffer
+                int NextPage()
+                {
+                    if (_touched == 0) {
+                        ++_touched;
+                    }
+
+                    return ToAddress(
+                               _random.Next(
+                                   static_cast<unsigned int>(_touched)
+                               ) * PAGE_SIZE
+                           );
+                }
+
+            private:
+                const ProcessClass &_class;
+                RandomStream &_random;
+
+                std::vector<int> _pages; // In the order of the first touch
+                std::size_t _touched;
+                unsigned int _position;  // Word of the touched pages
+
+                int ToAddress(unsigned int position) const
+                {
+                    return _class.base +
+                               _pages[position / PAGE_SIZE] * PAGE_SIZE +
+                               static_cast<int>(position % PAGE_SIZE);
+                }
+        };
+
+        void Push(GeneratedProgram &program, int opcode, int data)
+        {
+            Instruction instruction;
+            instruction.opcode = opcode;
+            instruction.data = data;
+            program.instructions.push_back(instruction);
+        }
+    }
+
+    RandomStream::RandomStream(const std::vector<std::uint32_t> &seeds)
+        : _engine()
+    {
+        std::seed_seq sequence(seeds.begin(), seeds.end());
+        _engine.seed(sequence);
+    }
+
+    unsigned int RandomStream::Next(unsigned int count)
+    {
+        return static_cast<unsigned int>(
+                   (static_cast<std::uint64_t>(_engine()) * count) >> 32
+               );
+    }
+
+    int RandomStream::Draw(const Range &range)
+    {
+        return range.min +
+                   static_cast<int>(
+                       Next(static_cast<unsigned int>(range.max - range.min) + 1)
+                   );
+    }
+
+    bool RandomStream::Chance(double probability)
+    {
+        return NextFraction() < probability;
+    }
+
+    double RandomStream::Exponential(double mean)
+    {
+        return -mean * std::log(1.0 - NextFraction());
+    }
+
+    double RandomStream::NextFraction()
+    {
+        // 53 random bits
+        std::uint64_t high = _engine() >> 5;
+        std::uint64_t low = _engine() >> 6;
+
+        return static_cast<double>((high << 26) | low) /
+                   9007199254740992.0;
+    }
+
+    std::vector<unsigned long long> Generator::DrawArrivals(const Spec &spec)
+    {
+        std::vector<unsigned long long> arrivals;
+        arrivals.reserve(spec.processes);
+
+        RandomStream random(std::vector<std::uint32_t>(1, spec.seed));
+        double cycle = 0.0;
+        for (unsigned int i = 0; i < spec.processes; ++i) {
+            if (spec.arrival == Uniform) {
+                cycle = static_cast<double>(i) * spec.arrival_interval;
+            } else if (spec.arrival == Poisson && i > 0) {
+                cycle += random.Exponential(spec.arrival_interval);
+            }
+            arrivals.push_back(static_cast<unsigned long long>(cycle));
+        }
+
+        return arrivals;
+    }
+
+    void Generator::Generate(
+                        const Spec &spec,
+                        unsigned int index,
+                        unsigned long long arrival,
+                        GeneratedProgram &program
+                    )
+    {
+        std::vector<std::uint32_t> seeds;
+        seeds.push_back(spec.seed);
+        seeds.push_back(index);
+        RandomStream random(seeds);
+
+        unsigned int weights = 0;
+        for (auto &process_class : spec.classes) {
+            weights += process_class.weight;
+        }
+        unsigned int pick = random.Next(weights);
+        const ProcessClass *process_class = &spec.classes[0];
+        for (auto &candidate : spec.classes) {
+            if (pick < candidate.weight) {
+                process_class = &candidate;
+                break;
+            }
+            pick -= candidate.weight;
+        }
+
+        program.priority = process_class->priority;
+        program.expected_burst =
+            (process_class->burst.min + process_class->burst.max) / 2;
+        program.working_set = process_class->working_set;
+        program.instructions.clear();
+
+        if (arrival > 0) {
+            Push(
+                program,
+                MOVA_OPCODE,
+                arrival > INT_MAX ? INT_MAX : static_cast<int>(arrival)
+            );
+            Push(program, INT_OPCODE, SLEEP_SYSCALL);
+        }
+
+        AccessStream accesses(*process_class, random);
+
+        int bursts = random.Draw(process_class->bursts);
+        for (int burst = 0; burst < bursts; ++burst) {
+            int length = random.Draw(process_class->burst);
+            for (int i = 0; i < length; ++i) {
+                int register_offset =
+                    static_cast<int>(random.Next(REGISTERS_COUNT));
+                if (random.Chance(process_class->memory)) {
+                    int opcode =
+                        random.Chance(process_class->stores) ?
+                            STA_OPCODE : LDA_OPCODE;
+                    Push(program, opcode + register_offset, accesses.Next());
+                } else {
+                    Push(
+                        program,
+                        MOVA_OPCODE + register_offset,
+                        static_cast<int>(random.Next(0x10000))
+                    );
+                }
+            }
+
+            if (burst + 1 == bursts || process_class->syscalls.empty()) {
+                continue;
+            }
+
+            const std::vector<Syscalls> &syscalls = process_class->syscalls;
+            Syscalls syscall =
+                syscalls[
+                    random.Next(static_cast<unsigned int>(syscalls.size()))
+                ];
+            if (syscall == SleepCall) {
+                Push(program, MOVA_OPCODE, random.Draw(process_class->sleep));
+                Push(program, INT_OPCODE, SLEEP_SYSCALL);
+            } else {
+                Push(
+                    program,
+                    MOVA_OPCODE,
+                    random.Draw(process_class->disk_blocks)
+                );
+                Push(program, MOVA_OPCODE + 1, accesses.NextPage());
+                Push(
+                    program,
+                    INT_OPCODE,
+                    random.Chance(0.5) ? DISK_READ_SYSCALL : DISK_WRITE_SYSCALL
+                );
+            }
+        }
+
+        Push(program, INT_OPCODE, EXIT_SYSCALL);
+    }
+
+    void Generator::Emit(
+                        const GeneratedProgram &program,
+                        std::vector<int> &ops
+                    )
+    {
+        int text_size = static_cast<int>(program.instructions.size() * 2);
+
+        ops.clear();
+        ops.reserve(OBJECT_TEXT_OFFSET + text_size);
+
+        ops.push_back(OBJECT_MAGIC);
+        ops.push_back(OBJECT_VERSION);
+        ops.push_back(0);
+        ops.push_back(program.priority);
+        ops.push_back(program.expected_burst);
+        ops.push_back(program.working_set);
+        ops.push_back(1);
+
+        ops.push_back(TEXT_SEGMENT);
+        ops.push_back(OBJECT_TEXT_OFFSET);
+        ops.push_back(text_size);
+        ops.push_back(0);
+        ops.push_back(text_size);
+        ops.resize(OBJECT_TEXT_OFFSET, 0);
+
+        for (auto &instruction : program.instructions) {
+            ops.push_back(instruction.opcode);
+            ops.push_back(instruction.data);
+        }
+    }
+
+    void Generator::WriteAssembly(
+                        const GeneratedProgram &program,
+                        std::ostream &output
+                    )
+    {
+        static const char *REGISTERS[REGISTERS_COUNT] = { "a", "b", "c" };
+
+        output << ".priority " << program.priority << std::endl
+               << ".burst " << program.expected_burst << std::endl
+               << ".working_set " << program.working_set << std::endl;
+
+        for (auto &instruction : program.instructions) {
+            if (instruction.opcode == INT_OPCODE) {
+                output << "  int " << instruction.data << std::endl;
+            } else if (instruction.opcode >= STA_OPCODE) {
+                output << "  st " << REGISTERS[instruction.opcode - STA_OPCODE]
+                       << " " << instruction.data << std::endl;
+            } else if (instruction.opcode >= LDA_OPCODE) {
+                output << "  ld " << REGISTERS[instruction.opcode - LDA_OPCODE]
+                       << " " << instruction.data << std::endl;
+            } else {
+                output << "  mov " << REGISTERS[instruction.opcode - MOVA_OPCODE]
+                       << " " << instruction.data << std::endl;
+            }
+        }
+    }
+}
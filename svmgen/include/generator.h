@@ -0,0 +1,105 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "spec.h"
+
+namespace svmgen
+{
+    // Instructions of `svm/include/cpu.h`
+    static const int MOVA_OPCODE = 0x10;
+    static const int INT_OPCODE  = 0x30;
+    static const int LDA_OPCODE  = 0x40;
+    static const int STA_OPCODE  = 0x50;
+
+    static const int REGISTERS_COUNT = 3; // `a`, `b`, `c` follow each other
+                                          //   in the opcodes
+
+    // System calls of `svm/include/syscalls.h`
+    static const int EXIT_SYSCALL       = 1;
+    static const int DISK_READ_SYSCALL  = 2;
+    static const int DISK_WRITE_SYSCALL = 3;
+    static const int SLEEP_SYSCALL      = 9;
+
+    static const int PAGE_SIZE   = 0x80;
+    static const int PAGES_COUNT = 0x200; // Entries of a page table
+
+    // SVM object format of `svm/include/executable.h`, a text segment only
+    static const int OBJECT_MAGIC       = 0x584d5653; // "SVMX"
+    static const int OBJECT_VERSION     = 1;
+    static const int TEXT_SEGMENT       = 0;
+    static const int OBJECT_TEXT_OFFSET = PAGE_SIZE;
+
+    // Seeded random numbers that are the same on every platform (the
+    //   distributions of the standard library are not)
+    class RandomStream
+    {
+        public:
+            explicit RandomStream(const std::vector<std::uint32_t> &seeds);
+
+            // Uniform in [0, count)
+            unsigned int Next(unsigned int count);
+            int Draw(const Range &range);
+            bool Chance(double probability);
+            double Exponential(double mean);
+
+        private:
+            std::mt19937 _engine;
+
+            double NextFraction();
+    };
+
+    struct Instruction
+    {
+        int opcode;
+        int data;
+    };
+
+    struct GeneratedProgram
+    {
+        int priority;
+        int expected_burst;
+        int working_set;
+        std::vector<Instruction> instructions;
+    };
+
+    // Synthetic Workload Generator
+    //
+    // Programs are straight-line code (the CPU has no conditional jumps):
+    // CPU bursts of `mov`/`ld`/`st` separated by system calls. A process
+    // that arrives late sleeps first. Every program has its own random
+    // stream made from the seed and its index, so any subset of a mix is
+    // generated the same way in any order
+    class Generator
+    {
+        public:
+            // Start cycles of the processes in the order of their indices
+            static std::vector<unsigned long long> DrawArrivals(
+                                                       const Spec &spec
+                                                   );
+
+            static void Generate(
+                            const Spec &spec,
+                            unsigned int index,
+                            unsigned long long arrival,
+                            GeneratedProgram &program
+                        );
+
+            // Object file words
+            static void Emit(
+                            const GeneratedProgram &program,
+                            std::vector<int> &ops
+                        );
+            // Assembly text for `svmasm`
+            static void WriteAssembly(
+                            const GeneratedProgram &program,
+                            std::ostream &output
+                        );
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef SPEC_H
+#define SPEC_H
+
+#include <string>
+#include <vector>
+
+namespace svmgen
+{
+    // Integer parameter drawn uniformly from [min, max] for every program
+    struct Range
+    {
+        int min;
+        int max;
+
+        Range();
+        Range(int min, int max);
+    };
+
+    enum AccessPatterns
+    {
+        Sequential, // The next word of the touched pages
+        Random,     // Any word of the touched pages
+        Strided     // `stride` words after the last access
+    };
+
+    enum Arrivals
+    {
+        AllAtOnce, // Every process starts at cycle 0
+        Uniform,   // One process every `arrival_interval` cycles
+        Poisson    // Exponential gaps with the mean of `arrival_interval`
+    };
+
+    enum Syscalls
+    {
+        SleepCall,
+        DiskCall
+    };
+
+    // A kind of process in the mix
+    struct ProcessClass
+    {
+        std::string name;
+        unsigned int weight;      // Share of the processes of this class
+
+        int priority;             // Object file hints for the schedulers
+        int working_set;          //   and the frame allocator
+
+        Range bursts;             // CPU bursts per program
+        Range burst;              // Instructions between system calls
+
+        double memory;            // Fraction of `ld`/`st` instructions
+        double stores;            // Fraction of stores among them
+
+        Range footprint;          // Pages the program may touch
+        int base;                 // Page aligned address of the first one
+        AccessPatterns pattern;
+        int stride;               // Words
+        double fault_rate;        // Chance that an access touches a page
+                                  //   of the footprint for the first time
+
+        std::vector<Syscalls> syscalls; // Ending the bursts, none if empty
+        Range sleep;              // Cycles
+        Range disk_blocks;        // Blocks the disk calls use
+
+        ProcessClass();
+    };
+
+    // Generator Specification
+    //
+    // Lines of `key = value`, `#` starts a comment. Ranges are given as
+    // `min max`. The global keys (`seed`, `processes`, `arrival`,
+    // `arrival_interval`, `name`) come first. Process class keys before the
+    // first `[class]` section are the defaults of every class, without any
+    // section a single class uses them
+    struct Spec
+    {
+        unsigned int seed;
+        unsigned int processes;
+        Arrivals arrival;
+        int arrival_interval;     // Cycles
+        std::string name;         // Prefix of the output files
+
+        std::vector<ProcessClass> classes;
+
+        Spec();
+
+        // On failure `error` has "<line>: <message>"
+        static bool Parse(
+                        const std::string &text,
+                        Spec &spec,
+                        std::string &error
+                    );
+    };
+}
+
+#endif
@@ -0,0 +1,313 @@
+#include "spec.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+
+#include "generator.h"
+
+namespace svmgen
+{
+    namespace
+    {
+        bool Fail(unsigned int line, const char *message, std::string &error)
+        {
+            error = std::to_string(line) + ": " + message;
+
+            return false;
+        }
+
+        std::string Trim(const std::string &text)
+        {
+            const char *spaces = " \t\r";
+            std::string::size_type begin = text.find_first_not_of(spaces);
+            if (begin == std::string::npos) {
+                return std::string();
+            }
+
+            return text.substr(begin, text.find_last_not_of(spaces) - begin + 1);
+        }
+
+        // Decimal or `0x` hexadecimal, not negative
+        bool ParseNumber(const std::string &text, int &number)
+        {
+            if (text.empty() || text[0] == '-') {
+                return false;
+            }
+
+            errno = 0;
+            char *end;
+            long value = std::strtol(text.c_str(), &end, 0);
+            if (*end != '\0' || errno != 0 || value > 0x7FFFFFFF) {
+                return false;
+            }
+            number = static_cast<int>(value);
+
+            return true;
+        }
+
+        bool ParseUnsigned(const std::string &text, unsigned int &number)
+        {
+            int value;
+            if (!ParseNumber(text, value)) {
+                return false;
+            }
+            number = static_cast<unsigned int>(value);
+
+            return true;
+        }
+
+        bool ParseRange(const std::string &text, Range &range)
+        {
+            std::istringstream words(text);
+            std::string min, max, rest;
+            words >> min >> max >> rest;
+            if (!rest.empty() || !ParseNumber(min, range.min)) {
+                return false;
+            }
+            if (max.empty()) {
+                range.max = range.min;
+                return true;
+            }
+
+            return ParseNumber(max, range.max) && range.min <= range.max;
+        }
+
+        bool ParseFraction(const std::string &text, double &fraction)
+        {
+            if (text.empty()) {
+                return false;
+            }
+
+            char *end;
+            fraction = std::strtod(text.c_str(), &end);
+
+            return *end == '\0' && fraction >= 0.0 && fraction <= 1.0;
+        }
+
+        bool ParseSyscalls(
+                 const std::string &text,
+                 std::vector<Syscalls> &syscalls
+             )
+        {
+            syscalls.clear();
+            if (text == "none") {
+                return true;
+            }
+
+            std::istringstream words(text);
+            std::string word;
+            while (words >> word) {
+                if (word == "sleep") {
+                    syscalls.push_back(SleepCall);
+                } else if (word == "disk") {
+                    syscalls.push_back(DiskCall);
+                } else {
+                    return false;
+                }
+            }
+
+            return !syscalls.empty();
+        }
+
+        // Returns false if `key` is not a class key or the value is bad,
+        //   `known` tells the two apart
+        bool ParseClassKey(
+                 const std::string &key,
+                 const std::string &value,
+                 ProcessClass &process_class,
+                 bool &known
+             )
+        {
+            known = true;
+
+            if (key == "weight") {
+                return ParseUnsigned(value, process_class.weight);
+            } else if (key == "priority") {
+                return ParseNumber(value, process_class.priority) &&
+                           process_class.priority <= 0xFFFF;
+            } else if (key == "working_set") {
+                return ParseNumber(value, process_class.working_set);
+            } else if (key == "bursts") {
+                return ParseRange(value, process_class.bursts) &&
+                           process_class.bursts.min > 0;
+            } else if (key == "burst") {
+                return ParseRange(value, process_class.burst);
+            } else if (key == "memory") {
+                return ParseFraction(value, process_class.memory);
+            } else if (key == "stores") {
+                return ParseFraction(value, process_class.stores);
+            } else if (key == "footprint") {
+                return ParseRange(value, process_class.footprint) &&
+                           process_class.footprint.min > 0;
+            } else if (key == "base") {
+                return ParseNumber(value, process_class.base) &&
+                           process_class.base % PAGE_SIZE == 0;
+            } else if (key == "pattern") {
+                if (value == "sequential") {
+                    process_class.pattern = Sequential;
+                } else if (value == "random") {
+                    process_class.pattern = Random;
+                } else if (value == "strided") {
+                    process_class.pattern = Strided;
+                } else {
+                    return false;
+                }
+                return true;
+            } else if (key == "stride") {
+                return ParseNumber(value, process_class.stride) &&
+                           process_class.stride > 0;
+            } else if (key == "fault_rate") {
+                return ParseFraction(value, process_class.fault_rate);
+            } else if (key == "syscalls") {
+                return ParseSyscalls(value, process_class.syscalls);
+            } else if (key == "sleep") {
+                return ParseRange(value, process_class.sleep);
+            } else if (key == "disk_blocks") {
+                return ParseRange(value, process_class.disk_blocks);
+            }
+
+            known = false;
+
+            return false;
+        }
+    }
+
+    Range::Range()
+        : min(0),
+          max(0) { }
+
+    Range::Range(int min, int max)
+        : min(min),
+          max(max) { }
+
+    ProcessClass::ProcessClass()
+        : name("process"),
+          weight(1),
+          priority(0),
+          working_set(0),
+          bursts(10, 10),
+          burst(100, 100),
+          memory(0.5),
+          stores(0.3),
+          footprint(8, 8),
+          base(0x1000),
+          pattern(Sequential),
+          stride(16),
+          fault_rate(0.01),
+          syscalls(1, SleepCall),
+          sleep(100, 100),
+          disk_blocks(0, 63) { }
+
+    Spec::Spec()
+        : seed(1),
+          processes(100),
+          arrival(AllAtOnce),
+          arrival_interval(1000),
+          name("process"),
+          classes() { }
+
+    bool Spec::Parse(
+                   const std::string &text,
+                   Spec &spec,
+                   std::string &error
+               )
+    {
+        spec = Spec();
+
+        ProcessClass defaults;
+        bool in_class = false;
+
+        std::istringstream lines(text);
+        std::string line;
+        unsigned int line_number = 0;
+        while (std::getline(lines, line)) {
+            ++line_number;
+
+            line = Trim(line.substr(0, line.find('#')));
+            if (line.empty()) {
+                continue;
+            }
+
+            if (line[0] == '[') {
+                if (line[line.size() - 1] != ']' || line.size() < 3) {
+                    return Fail(line_number, "Invalid class section.", error);
+                }
+                spec.classes.push_back(defaults);
+                spec.classes.back().name = Trim(line.substr(1, line.size() - 2));
+                in_class = true;
+
+                continue;
+            }
+
+            std::string::size_type equals = line.find('=');
+            if (equals == std::string::npos) {
+                return Fail(line_number, "Expected `key = value`.", error);
+            }
+            std::string key = Trim(line.substr(0, equals));
+            std::string value = Trim(line.substr(equals + 1));
+
+            bool known;
+            ProcessClass &process_class =
+                in_class ? spec.classes.back() : defaults;
+            if (ParseClassKey(key, value, process_class, known)) {
+                continue;
+            }
+            if (known) {
+                return Fail(line_number, "Invalid value.", error);
+            }
+
+            bool valid;
+            if (in_class) {
+                return Fail(line_number, "Unknown class key.", error);
+            } else if (key == "seed") {
+                valid = ParseUnsigned(value, spec.seed);
+            } else if (key == "processes") {
+                valid = ParseUnsigned(value, spec.processes) &&
+                            spec.processes > 0;
+            } else if (key == "arrival") {
+                valid = true;
+                if (value == "all") {
+                    spec.arrival = AllAtOnce;
+                } else if (value == "uniform") {
+                    spec.arrival = Uniform;
+                } else if (value == "poisson") {
+                    spec.arrival = Poisson;
+                } else {
+                    valid = false;
+                }
+            } else if (key == "arrival_interval") {
+                valid = ParseNumber(value, spec.arrival_interval);
+            } else if (key == "name") {
+                valid = !value.empty() &&
+                            value.find_first_of("/\\") == std::string::npos;
+                spec.name = value;
+            } else {
+                return Fail(line_number, "Unknown key.", error);
+            }
+            if (!valid) {
+                return Fail(line_number, "Invalid value.", error);
+            }
+        }
+
+        if (spec.classes.empty()) {
+            spec.classes.push_back(defaults);
+        }
+
+        unsigned int weights = 0;
+        for (auto &process_class : spec.classes) {
+            weights += process_class.weight;
+
+            // The footprint has to fit into the address space
+            if (process_class.base / PAGE_SIZE + process_class.footprint.max >
+                    PAGES_COUNT) {
+                return Fail(line_number, "A footprint is out of memory.", error);
+            }
+        }
+        if (weights == 0) {
+            return Fail(line_number, "No class has a weight.", error);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,200 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "generator.h"
+#include "spec.h"
+
+using namespace svmgen;
+
+// `<directory>/<name>_<index>.bin`, indices are padded to sort in order
+static std::string GetOutputFileName(
+                       const std::string &directory,
+                       const Spec &spec,
+                       unsigned int index,
+                       const char *extension
+                   )
+{
+    std::string number = std::to_string(index);
+    std::string::size_type width = std::to_string(spec.processes - 1).size();
+    if (number.size() < width) {
+        number.insert(0, width - number.size(), '0');
+    }
+
+    return directory + "/" + spec.name + "_" + number + extension;
+}
+
+// Generates one program, returns an empty string on success or an error
+static std::string GenerateFile(
+                       const Spec &spec,
+                       const std::string &directory,
+                       unsigned int index,
+                       unsigned long long arrival,
+                       bool assembly,
+                       std::size_t &words_count
+                   )
+{
+    GeneratedProgram program;
+    Generator::Generate(spec, index, arrival, program);
+
+    std::vector<int> ops;
+    Generator::Emit(program, ops);
+    words_count = ops.size();
+
+    std::string output_file_name =
+        GetOutputFileName(directory, spec, index, ".bin");
+    std::ofstream output_stream(
+        output_file_name,
+        std::ios::out | std::ios::binary
+    );
+    if (!output_stream) {
+        return output_file_name + ": failed to open the output file.";
+    }
+    output_stream.write(
+        reinterpret_cast<const char *>(&ops[0]),
+        ops.size() * sizeof(int)
+    );
+    if (output_stream.bad()) {
+        return output_file_name + ": failed to write the output file.";
+    }
+
+    if (assembly) {
+        std::string assembly_file_name =
+            GetOutputFileName(directory, spec, index, ".asm");
+        std::ofstream assembly_stream(assembly_file_name);
+        Generator::WriteAssembly(program, assembly_stream);
+        if (!assembly_stream) {
+            return assembly_file_name + ": failed to write the output file.";
+        }
+    }
+
+    return std::string();
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int jobs_count = std::thread::hardware_concurrency();
+    bool assembly = false;
+
+    int argument_index = 1;
+    for (; argument_index < argc; ++argument_index) {
+        std::string argument(argv[argument_index]);
+        if (argument == "-S") {
+            assembly = true;
+        } else if (argument == "-j" && argument_index + 1 < argc) {
+            jobs_count =
+                std::strtoul(argv[++argument_index], NULL, 10);
+        } else {
+            break;
+        }
+    }
+
+    if (argc - argument_index != 2) {
+        std::cerr << "The syntax of the command is incorrect."
+                  << std::endl
+                  << " svmgen [-S] [-j <jobs>] <spec file> <output directory>"
+                  << std::endl << std::endl;
+
+        return -1;
+    }
+
+    std::ifstream spec_stream(argv[argument_index]);
+    if (!spec_stream) {
+        std::cerr << "Failed to open the spec file." << std::endl;
+
+        return -1;
+    }
+    std::stringstream spec_text;
+    spec_text << spec_stream.rdbuf();
+
+    Spec spec;
+    std::string error;
+    if (!Spec::Parse(spec_text.str(), spec, error)) {
+        std::cerr << argv[argument_index] << ":" << error << std::endl;
+
+        return -1;
+    }
+    std::string directory(argv[argument_index + 1]);
+
+    if (jobs_count == 0) {
+        jobs_count = 1;
+    }
+    if (jobs_count > spec.processes) {
+        jobs_count = spec.processes;
+    }
+
+    std::vector<unsigned long long> arrivals = Generator::DrawArrivals(spec);
+    std::vector<std::string> errors(spec.processes);
+    std::vector<std::size_t> sizes(spec.processes);
+    std::atomic<unsigned int> next_index(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Programs are independent, workers take the next one until none is
+    //   left
+    auto worker = [&]() {
+        for (unsigned int index = next_index++;
+                 index < spec.processes; index = next_index++) {
+            errors[index] =
+                GenerateFile(
+                    spec,
+                    directory,
+                    index,
+                    arrivals[index],
+                    assembly,
+                    sizes[index]
+                );
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < jobs_count; ++i) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    double seconds =
+        std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+
+    // The mix lists the programs in the order they arrive, ready for the
+    //   command line of `svm`
+    std::string mix_file_name = directory + "/" + spec.name + ".mix";
+    std::ofstream mix_stream(mix_file_name);
+    for (unsigned int index = 0; index < spec.processes; ++index) {
+        mix_stream << GetOutputFileName(directory, spec, index, ".bin")
+                   << std::endl;
+    }
+
+    int result = 0;
+    if (!mix_stream) {
+        std::cerr << mix_file_name << ": failed to write the output file."
+                  << std::endl;
+        result = -1;
+    }
+
+    std::size_t total_words = 0;
+    for (unsigned int index = 0; index < spec.processes; ++index) {
+        if (!errors[index].empty()) {
+            std::cerr << errors[index] << std::endl;
+            result = -1;
+        }
+        total_words += sizes[index];
+    }
+
+    std::cerr << "svmgen: " << spec.processes << " program(s), "
+              << total_words << " word(s) in " << seconds * 1000.0 << " ms."
+              << std::endl;
+
+    return result;
+}
@@ -0,0 +1,207 @@
+#include "decoder.h"
+
+namespace svmtrace
+{
+    namespace
+    {
+        const char *EVENT_NAMES[EventsCount] = {
+            "invalid opcode",
+            "out of memory",
+            "page fault",
+            "context switch",
+            "syscall",
+            "alloc",
+            "free",
+            "dropped"
+        };
+
+        const char *GetEventName(unsigned int type)
+        {
+            return type < EventsCount ? EVENT_NAMES[type] : "unknown";
+        }
+
+        void WriteProcess(std::ostream &output, unsigned int process_id)
+        {
+            if (process_id == KERNEL_PROCESS) {
+                output << "kernel";
+            } else {
+                output << process_id;
+            }
+        }
+
+        // Names of the two values of each event type
+        void WriteArguments(std::ostream &output, const Event &event, bool json)
+        {
+            const char *names[2] = { NULL, NULL };
+            switch (event.type) {
+                case InvalidOpcode:
+                    names[0] = "opcode"; names[1] = "ip";
+                    break;
+                case OutOfMemory:
+                    names[0] = "page";
+                    break;
+                case PageFault:
+                    names[0] = "page"; names[1] = "frame";
+                    break;
+                case ContextSwitch:
+                    names[0] = "ip";
+                    break;
+                case Syscall:
+                    names[0] = "number"; names[1] = "a";
+                    break;
+                case Alloc:
+                    names[0] = "address"; names[1] = "words";
+                    break;
+                case Free:
+                    names[0] = "address";
+                    break;
+                case Dropped:
+                    names[0] = "events";
+                    break;
+                default:
+                    names[0] = "value0"; names[1] = "value1";
+                    break;
+            }
+
+            bool first = true;
+            for (int i = 0; i < 2; ++i) {
+                if (!names[i]) {
+                    continue;
+                }
+
+                if (json) {
+                    output << (first ? "" : ",") << "\"" << names[i] << "\":"
+                           << event.values[i];
+                } else {
+                    output << " " << names[i] << "=" << event.values[i];
+                }
+                first = false;
+            }
+        }
+    }
+
+    TraceFile::TraceFile()
+        : _input(),
+          _event_size(0) { }
+
+    bool TraceFile::Open(const std::string &path, std::string &error)
+    {
+        _input.open(path, std::ios::in | std::ios::binary);
+        if (!_input) {
+            error = "Failed to open the trace file.";
+            return false;
+        }
+
+        unsigned int header[4];
+        if (!_input.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+                header[0] != TRACE_MAGIC) {
+            error = "Not a trace file.";
+            return false;
+        }
+        if (header[1] != TRACE_VERSION || header[2] < sizeof(Event)) {
+            error = "Unsupported trace version.";
+            return false;
+        }
+        _event_size = header[2];
+
+        return true;
+    }
+
+    bool TraceFile::Next(Event &event)
+    {
+        if (!_input.read(reinterpret_cast<char *>(&event), sizeof(Event))) {
+            return false;
+        }
+        // Newer writers may append fields
+        _input.ignore(_event_size - sizeof(Event));
+
+        return true;
+    }
+
+    void Decoder::WriteText(TraceFile &trace, std::ostream &output)
+    {
+        unsigned int current_process = KERNEL_PROCESS;
+
+        Event event;
+        while (trace.Next(event)) {
+            if (event.type == ContextSwitch) {
+                current_process = event.process_id;
+            }
+            unsigned int process_id =
+                event.process_id == CURRENT_PROCESS ?
+                    current_process : event.process_id;
+
+            output << event.cycle << " ";
+            WriteProcess(output, process_id);
+            output << " " << GetEventName(event.type);
+            WriteArguments(output, event, false);
+            output << "\n";
+        }
+    }
+
+    void Decoder::WriteChromeTrace(TraceFile &trace, std::ostream &output)
+    {
+        unsigned int current_process = KERNEL_PROCESS;
+        bool running = false;
+        unsigned long long last_cycle = 0;
+
+        output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+        bool first = true;
+        auto begin_event = [&]() {
+            output << (first ? "" : ",\n");
+            first = false;
+        };
+
+        Event event;
+        while (trace.Next(event)) {
+            last_cycle = event.cycle;
+
+            if (event.type == ContextSwitch) {
+                // The previous slice ends where the next one starts
+                if (running) {
+                    begin_event();
+                    output << "{\"name\":\"running\",\"ph\":\"E\",\"pid\":0,"
+                           << "\"tid\":" << current_process
+                           << ",\"ts\":" << event.cycle << "}";
+                }
+
+                current_process = event.process_id;
+                running = true;
+
+                begin_event();
+                output << "{\"name\":\"running\",\"ph\":\"B\",\"pid\":0,"
+                       << "\"tid\":" << current_process
+                       << ",\"ts\":" << event.cycle << ",\"args\":{";
+                WriteArguments(output, event, true);
+                output << "}}";
+
+                continue;
+            }
+
+            unsigned int process_id =
+                event.process_id == CURRENT_PROCESS ?
+                    current_process : event.process_id;
+
+            // Instant events on the track of the process, kernel events on
+            //   a track of their own
+            begin_event();
+            output << "{\"name\":\"" << GetEventName(event.type)
+                   << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":"
+                   << (process_id == KERNEL_PROCESS ? -1 :
+                           static_cast<long long>(process_id))
+                   << ",\"ts\":" << event.cycle << ",\"args\":{";
+            WriteArguments(output, event, true);
+            output << "}}";
+        }
+
+        if (running) {
+            begin_event();
+            output << "{\"name\":\"running\",\"ph\":\"E\",\"pid\":0,"
+                   << "\"tid\":" << current_process
+                   << ",\"ts\":" << last_cycle << "}";
+        }
+
+        output << "\n]}\n";
+    }
+}
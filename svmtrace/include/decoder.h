@@ -0,0 +1,69 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <fstream>
+#include <ostream>
+#include <string>
+
+namespace svmtrace
+{
+    // Layout of the trace written by `svm/trace.cpp`
+    static const unsigned int TRACE_MAGIC   = 0x544d5653; // "SVMT"
+    static const unsigned int TRACE_VERSION = 1;
+
+    static const unsigned int KERNEL_PROCESS  = 0xFFFFFFFF;
+    static const unsigned int CURRENT_PROCESS = 0xFFFFFFFE;
+
+    enum Events
+    {
+        InvalidOpcode,
+        OutOfMemory,
+        PageFault,
+        ContextSwitch,
+        Syscall,
+        Alloc,
+        Free,
+        Dropped,
+        EventsCount
+    };
+
+    struct Event
+    {
+        unsigned long long cycle;
+        unsigned int type;
+        unsigned int process_id;
+        long long values[2];
+    };
+
+    // Reads events one at a time, the file may be any size
+    class TraceFile
+    {
+        public:
+            TraceFile();
+
+            // On failure `error` has the reason
+            bool Open(const std::string &path, std::string &error);
+            bool Next(Event &event);
+
+        private:
+            std::ifstream _input;
+            unsigned int _event_size;
+    };
+
+    // The output keeps the file order, events of different threads are not
+    // merged by cycle. `CURRENT_PROCESS` is resolved with the last context
+    // switch
+    class Decoder
+    {
+        public:
+            // One line per event
+            static void WriteText(TraceFile &trace, std::ostream &output);
+
+            // Chrome trace event JSON (chrome://tracing, Perfetto), one
+            // track per process with a slice per time on the CPU. Cycles
+            // are written as microseconds
+            static void WriteChromeTrace(TraceFile &trace, std::ostream &output);
+    };
+}
+
+#endif
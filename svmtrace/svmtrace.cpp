@@ -0,0 +1,53 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "decoder.h"
+
+using namespace svmtrace;
+
+int main(int argc, char *argv[])
+{
+    bool json = false;
+    int argument_index = 1;
+    if (argument_index < argc && std::string(argv[argument_index]) == "-json") {
+        json = true;
+        ++argument_index;
+    }
+
+    if (argc - argument_index < 1 || argc - argument_index > 2) {
+        std::cerr << "The syntax of the command is incorrect."
+                  << std::endl
+                  << " svmtrace [-json] <trace file> [<output file>]"
+                  << std::endl << std::endl;
+
+        return -1;
+    }
+
+    TraceFile trace;
+    std::string error;
+    if (!trace.Open(argv[argument_index], error)) {
+        std::cerr << argv[argument_index] << ": " << error << std::endl;
+
+        return -1;
+    }
+
+    std::ofstream output_file;
+    if (argc - argument_index == 2) {
+        output_file.open(argv[argument_index + 1]);
+        if (!output_file) {
+            std::cerr << "Failed to open the output file." << std::endl;
+
+            return -1;
+        }
+    }
+    std::ostream &output = output_file.is_open() ? output_file : std::cout;
+
+    if (json) {
+        Decoder::WriteChromeTrace(trace, output);
+    } else {
+        Decoder::WriteText(trace, output);
+    }
+
+    return output.bad() ? -1 : 0;
+}